@@ -26,6 +26,8 @@ initCirCmd()
          cmdMgr->regCmd("CIRGate", 4, new CirGateCmd) &&
          cmdMgr->regCmd("CIRSWeep", 5, new CirSweepCmd) &&
          cmdMgr->regCmd("CIROPTimize", 6, new CirOptCmd) &&
+         cmdMgr->regCmd("CIRREWrite", 6, new CirRewriteCmd) &&
+         cmdMgr->regCmd("CIRBALance", 6, new CirBalanceCmd) &&
          cmdMgr->regCmd("CIRSTRash", 6, new CirStrashCmd) &&
          cmdMgr->regCmd("CIRSIMulate", 6, new CirSimCmd) &&
          cmdMgr->regCmd("CIRFraig", 4, new CirFraigCmd) &&
@@ -326,6 +328,90 @@ CirOptCmd::help() const
         << "perform trivial optimizations\n";
 }
 
+//----------------------------------------------------------------------
+//    CIRREWrite
+//----------------------------------------------------------------------
+CmdExecStatus
+CirRewriteCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   CmdExec::lexOptions(option, options);
+
+   if (!options.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+
+   assert(curCmd != CIRINIT);
+   if (curCmd == CIRSIMULATE) {
+      cerr << "Error: circuit has been simulated!! Do \"CIRFraig\" first!!"
+           << endl;
+      return CMD_EXEC_ERROR;
+   }
+   cirMgr->rewrite();
+   curCmd = CIROPT;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirRewriteCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRREWrite" << endl;
+}
+
+void
+CirRewriteCmd::help() const
+{
+   cout << setw(15) << left << "CIRREWrite: "
+        << "rewrite 4-input cuts with the smallest AIGs of their functions\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRBALance
+//----------------------------------------------------------------------
+CmdExecStatus
+CirBalanceCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   CmdExec::lexOptions(option, options);
+
+   if (!options.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+
+   assert(curCmd != CIRINIT);
+   if (curCmd == CIRSIMULATE) {
+      cerr << "Error: circuit has been simulated!! Do \"CIRFraig\" first!!"
+           << endl;
+      return CMD_EXEC_ERROR;
+   }
+   cirMgr->balance();
+   curCmd = CIROPT;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirBalanceCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRBALance" << endl;
+}
+
+void
+CirBalanceCmd::help() const
+{
+   cout << setw(15) << left << "CIRBALance: "
+        << "balance AND trees to reduce the logic depth\n";
+}
+
 //----------------------------------------------------------------------
 //    CIRSTRash
 //----------------------------------------------------------------------
@@ -374,7 +460,7 @@ CirStrashCmd::help() const
 
 //----------------------------------------------------------------------
 //    CIRSIMulate <-Random | -File <string patternFile>>
-//                [-Output (string logFile)]
+//                [-Output (string logFile)] [-Limit (int rounds)]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirSimCmd::exec(const string& option)
@@ -389,7 +475,8 @@ CirSimCmd::exec(const string& option)
 
    ifstream patternFile;
    ofstream logFile;
-   bool doRandom = false, doFile = false, doLog = false;
+   bool doRandom = false, doFile = false, doLog = false, doLimit = false;
+   int limit = 0;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Random", options[i], 2) == 0) {
          if (doRandom || doFile)
@@ -416,6 +503,15 @@ CirSimCmd::exec(const string& option)
             return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[i]);
          doLog = true;
       }
+      else if (myStrNCmp("-Limit", options[i], 2) == 0) {
+         if (doLimit)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], limit) || limit <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doLimit = true;
+      }
       else
          return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
    }
@@ -427,6 +523,8 @@ CirSimCmd::exec(const string& option)
    if (doLog)
       cirMgr->setSimLog(&logFile);
    else cirMgr->setSimLog(0);
+   if (doLimit)
+      cirMgr->setSimLimit(limit);
 
    if (doRandom)
       cirMgr->randomSim();
@@ -442,7 +540,7 @@ void
 CirSimCmd::usage(ostream& os) const
 {
    os << "Usage: CIRSIMulate <-Random | -File <string patternFile>>"
-      << "                   [-Output (string logFile)]" << endl;
+      << "                   [-Output (string logFile)] [-Limit (int rounds)]" << endl;
 }
 
 void
@@ -453,7 +551,8 @@ CirSimCmd::help() const
 }
 
 //----------------------------------------------------------------------
-//    CIRFraig
+//    CIRFraig [-THread (int num)] [-ConfLimit (int conflicts)]
+//             [-PropLimit (int propagations)] [-TIme (int seconds)]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirFraigCmd::exec(const string& option)
@@ -466,14 +565,55 @@ CirFraigCmd::exec(const string& option)
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
-   if (!options.empty())
-      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+   bool doThread = false, doConf = false, doProp = false, doTime = false;
+   int threads = 1, conf = 0, prop = 0, sec = 0;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-THread", options[i], 3) == 0) {
+         if (doThread)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], threads) || threads <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doThread = true;
+      }
+      else if (myStrNCmp("-ConfLimit", options[i], 2) == 0) {
+         if (doConf)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], conf) || conf <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doConf = true;
+      }
+      else if (myStrNCmp("-PropLimit", options[i], 2) == 0) {
+         if (doProp)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], prop) || prop <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doProp = true;
+      }
+      else if (myStrNCmp("-TIme", options[i], 3) == 0) {
+         if (doTime)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], sec) || sec <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doTime = true;
+      }
+      else
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
 
    if (curCmd != CIRSIMULATE) {
       cerr << "Error: circuit is not yet simulated!!" << endl;
       return CMD_EXEC_ERROR;
    }
-   cirMgr->fraig();
+   cirMgr->setFraigLimit(conf, prop, sec);
+   cirMgr->fraig(threads);
    curCmd = CIRFRAIG;
 
    return CMD_EXEC_DONE;
@@ -482,7 +622,8 @@ CirFraigCmd::exec(const string& option)
 void
 CirFraigCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRFraig" << endl;
+   os << "Usage: CIRFraig [-THread (int num)] [-ConfLimit (int conflicts)]\n"
+      << "                [-PropLimit (int propagations)] [-TIme (int seconds)]" << endl;
 }
 
 void
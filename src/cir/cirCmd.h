@@ -16,6 +16,8 @@ CmdClass(CirPrintCmd);
 CmdClass(CirGateCmd);
 CmdClass(CirSweepCmd);
 CmdClass(CirOptCmd);
+CmdClass(CirRewriteCmd);
+CmdClass(CirBalanceCmd);
 CmdClass(CirStrashCmd);
 CmdClass(CirSimCmd);
 CmdClass(CirFraigCmd);
@@ -0,0 +1,147 @@
+/****************************************************************************
+  FileName     [ cirCut.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir cut enumeration functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-2013 LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <algorithm>
+#include "cirMgr.h"
+#include "cirCut.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+// Better cuts first: shallower, then smaller area flow, then fewer leaves
+struct CutLess
+{
+	bool operator () (const CirCut& a, const CirCut& b) const {
+		if (a.depth != b.depth) return a.depth < b.depth;
+		if (a.flow != b.flow) return a.flow < b.flow;
+		return a.nLeaves < b.nLeaves;
+	}
+};
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static inline SimWord
+phase(bool inv)
+{
+	return inv ? ~(SimWord)0 : 0;
+}
+
+// Swap variables v and v+1 of a truth table
+static inline SimWord
+swapAdjacent(SimWord t, unsigned v)
+{
+	static const SimWord mask[5][3] = {
+		{ 0x9999999999999999ULL, 0x2222222222222222ULL, 0x4444444444444444ULL },
+		{ 0xc3c3c3c3c3c3c3c3ULL, 0x0c0c0c0c0c0c0c0cULL, 0x3030303030303030ULL },
+		{ 0xf00ff00ff00ff00fULL, 0x00f000f000f000f0ULL, 0x0f000f000f000f00ULL },
+		{ 0xff0000ffff0000ffULL, 0x0000ff000000ff00ULL, 0x00ff000000ff0000ULL },
+		{ 0xffff00000000ffffULL, 0x00000000ffff0000ULL, 0x0000ffff00000000ULL } };
+	unsigned s = 1u << v;
+	return (t & mask[v][0]) | ((t & mask[v][1]) << s) | ((t & mask[v][2]) >> s);
+}
+
+// Truth table of cut "from" over the leaves of "to", a superset of them
+static SimWord
+stretch(const CirCut& from, const CirCut& to)
+{
+	SimWord t = from.truth;
+	unsigned j = to.nLeaves;
+	for (unsigned i = from.nLeaves; i-- > 0; ){
+		while (to.leaves[--j] != from.leaves[i]);
+		for (unsigned v = i; v < j; v++) t = swapAdjacent(t, v);
+	}
+	return t;
+}
+
+// Union of the leaves of a and b in c; false if it has more than k leaves
+static bool
+mergeLeaves(const CirCut& a, const CirCut& b, unsigned k, CirCut& c)
+{
+	unsigned i = 0, j = 0, n = 0;
+	while (i < a.nLeaves || j < b.nLeaves){
+		if (n == k) return false;
+		if (j == b.nLeaves || (i < a.nLeaves && a.leaves[i] < b.leaves[j])) c.leaves[n++] = a.leaves[i++];
+		else if (i == a.nLeaves || b.leaves[j] < a.leaves[i]) c.leaves[n++] = b.leaves[j++];
+		else { c.leaves[n++] = a.leaves[i++]; j++; }
+	}
+	c.nLeaves = n;
+	c.sign = a.sign | b.sign;
+	return true;
+}
+
+/*****************************************/
+/*   Public member functions about cuts   */
+/*****************************************/
+// Priority cuts of every gate in the DFS order. The cuts of an AIG gate
+// are merged from the cuts of its fanins; a cut with more than "size"
+// leaves or with a subset among the other cuts is dropped, and only the
+// "limit" best ones are kept with the trivial cut. PIs, UNDEF gates and
+// the constant only have the trivial cut. Fanins are read as they are, so
+// pending merges should be cleaned up first.
+void
+CirMgr::buildCuts(CutTable& t, unsigned size, unsigned limit)
+{
+	if (size < 2) size = 2;
+	if (size > CUT_SIZE) size = CUT_SIZE;
+	if (limit < 1) limit = 1;
+	if (limit > 254) limit = 254;
+	buildDFS();
+	buildFanout();
+	t.init(_gates.size(), size, limit);
+	vector<CirCut> cuts;
+	for (IdList::iterator it = _dfsList.begin(); it != _dfsList.end(); it++){
+		unsigned id = *it;
+		if (_types[id] == PO_GATE) continue;
+		cuts.clear();
+		if (_types[id] == AIG_GATE){
+			unsigned in0 = _fanin0[id], in1 = _fanin1[id];
+			unsigned n0 = t.cutNum(in0/2), n1 = t.cutNum(in1/2);
+			assert(n0 > 0 && n1 > 0);
+			for (unsigned i = 0; i < n0; i++)
+				for (unsigned j = 0; j < n1; j++){
+					const CirCut& a = t.getCut(in0/2, i);
+					const CirCut& b = t.getCut(in1/2, j);
+					CirCut c;
+					if (!mergeLeaves(a, b, size, c)) continue;
+					bool dominated = false;
+					for (size_t k = 0; k < cuts.size() && !dominated; k++)
+						dominated = cuts[k].subsetOf(c);
+					if (dominated) continue;
+					size_t m = 0;
+					for (size_t k = 0; k < cuts.size(); k++)
+						if (!c.subsetOf(cuts[k])) cuts[m++] = cuts[k];
+					cuts.resize(m);
+					c.truth = (stretch(a, c) ^ phase(in0 & 1)) & (stretch(b, c) ^ phase(in1 & 1));
+					c.depth = 0;
+					c.flow = 1;
+					for (unsigned k = 0; k < c.nLeaves; k++){
+						unsigned d = t.getDepth(c.leaves[k]);
+						if (d >= c.depth) c.depth = d+1;
+						c.flow += t.getFlow(c.leaves[k]);
+					}
+					cuts.push_back(c);
+				}
+			sort(cuts.begin(), cuts.end(), CutLess());
+			if (cuts.size() > limit) cuts.resize(limit);
+		}
+		CirCut triv;
+		triv.leaves[0] = id;
+		triv.nLeaves = 1;
+		triv.sign = 1u << (id % 32);
+		triv.truth = 0xaaaaaaaaaaaaaaaaULL;
+		triv.depth = cuts.empty()? 0 : cuts[0].depth;
+		triv.flow = cuts.empty()? 0 : cuts[0].flow;
+		cuts.push_back(triv);
+		unsigned fo = _foStart[id+1]-_foStart[id];
+		t.setCuts(id, cuts, cuts[0].flow / (fo > 1? fo : 1));
+	}
+}
@@ -0,0 +1,93 @@
+/****************************************************************************
+  FileName     [ cirCut.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the k-feasible cuts of the AIG gates ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-2013 LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_CUT_H
+#define CIR_CUT_H
+
+#include <vector>
+#include "cirDef.h"
+
+using namespace std;
+
+// A cut has at most CUT_SIZE leaves, so its truth table fits in one word
+#define CUT_SIZE      6
+
+//------------------------------------------------------------------------
+//   Define classes
+//------------------------------------------------------------------------
+// A cut of a gate: its leaves in increasing id order and the function of
+// the gate over them. Leaf i is variable i of the truth table, which
+// repeats itself above the nLeaves-th variable.
+struct CirCut
+{
+   unsigned          leaves[CUT_SIZE];
+   SimWord           truth;
+   unsigned          sign;     // bit (leaf % 32) of every leaf, for quick subset tests
+   float             flow;     // area flow of the gate when it is built from this cut
+   unsigned short    depth;    // 1 + the deepest leaf (0 for the cut of a PI)
+   unsigned char     nLeaves;
+
+   // True if every leaf of this cut is a leaf of c
+   bool subsetOf(const CirCut& c) const {
+      if (nLeaves > c.nLeaves || (sign & ~c.sign)) return false;
+      for (unsigned i = 0, j = 0; i < nLeaves; i++, j++){
+         while (j < c.nLeaves && c.leaves[j] < leaves[i]) j++;
+         if (j == c.nLeaves || c.leaves[j] != leaves[i]) return false;
+      }
+      return true;
+   }
+};
+
+// The priority cuts of every gate, kept contiguously in one arena. The
+// cuts of a gate are ordered best first (by depth, area flow and leaves),
+// and the last one is always the trivial cut {id}. The depth and flow of a
+// gate are those of its best cut.
+class CutTable
+{
+public:
+   CutTable() : _size(0), _limit(0) {}
+   ~CutTable() {}
+
+   unsigned getCutSize() const { return _size; }
+   unsigned getLimit() const { return _limit; }
+   unsigned cutNum(unsigned id) const { return (id < _num.size())? _num[id] : 0; }
+   const CirCut& getCut(unsigned id, unsigned i) const { return _cuts[_begin[id]+i]; }
+   unsigned getDepth(unsigned id) const { return _depth[id]; }
+   float getFlow(unsigned id) const { return _flow[id]; }
+   size_t size() const { return _cuts.size(); }
+
+   // Filled by CirMgr::buildCuts() in topological order
+   void init(size_t gates, unsigned size, unsigned limit) {
+      _size = size;
+      _limit = limit;
+      _cuts.clear();
+      _begin.assign(gates, 0);
+      _num.assign(gates, 0);
+      _depth.assign(gates, 0);
+      _flow.assign(gates, 0);
+   }
+   void setCuts(unsigned id, const vector<CirCut>& cuts, float flow) {
+      _begin[id] = _cuts.size();
+      _num[id] = cuts.size();
+      _cuts.insert(_cuts.end(), cuts.begin(), cuts.end());
+      _depth[id] = cuts[0].depth;
+      _flow[id] = flow;
+   }
+   void clear() { init(0, 0, 0); }
+
+private:
+   unsigned                _size;     // most leaves of a cut
+   unsigned                _limit;    // most cuts of a gate besides the trivial one
+   vector<CirCut>          _cuts;
+   IdList                  _begin;    // [gate id] -> first cut in _cuts
+   vector<unsigned char>   _num;      // [gate id] -> number of cuts, 0 if not enumerated
+   IdList                  _depth;
+   vector<float>           _flow;
+};
+
+#endif // CIR_CUT_H
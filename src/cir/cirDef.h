@@ -13,14 +13,27 @@
 #include <map>
 #include <string>
 #include <time.h>
+#include <stdint.h>
 
 #include "sat.h"
 
 using namespace std;
 
 #define XOR(a,b) ((a && !b) || (!a && b))
-#define BtoS(a) ((a)?"0":"1")
-#define StoB(a) ((a == '0')?false:true)
+
+// Simulation packs SIM_WORD_BITS patterns into one word per gate and
+// evaluates SIM_WORDS words (one AVX-512 register) per gate in each round
+#define SIM_WORD_BITS 64
+#define SIM_WORDS     8
+#define SIM_PATTERNS  (SIM_WORD_BITS*SIM_WORDS)
+
+// Exact truth tables in fraig cover cones of up to TT_VARS PIs, in up to
+// TT_WORDS words
+#define TT_VARS       8
+#define TT_WORDS      4
+
+// Class index of a gate that is in no FEC class
+#define NO_FEC        (~0u)
 
 class CirPValue;
 class CirGateV;
@@ -30,14 +43,14 @@ class CirPoGate;
 class CirMgr;
 class SatSolver;
 
-typedef map<unsigned, CirGate*>    GateList;
 typedef vector<CirGate*>           GateVList;
-typedef map<string, GateVList>     FEClist;
+typedef uint64_t                   SimWord;
 typedef vector<unsigned>           IdList;
+typedef vector<IdList>             FEClist;    // FEC classes of literals (id*2 + phase)
 typedef CirGate**                  GateArray;
 typedef CirPiGate**                PiArray;
 typedef CirPoGate**                PoArray;
-typedef map<CirGate*, Var>         SatTable;
+typedef vector<Var>                SatTable;   // [gate id] -> Var
 
 enum GateType
 {
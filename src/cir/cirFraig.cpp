@@ -7,21 +7,165 @@
 ****************************************************************************/
 
 #include <cassert>
+#include <algorithm>
+#include <pthread.h>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "sat.h"
-#include "myHash.h"
 #include "util.h"
+#include "rnGen.h"
 
 using namespace std;
 
 /*******************************/
 /*   Global variable and enum  */
 /*******************************/
+// A SAT solver and the variables of the gates whose CNF it holds. The CNF
+// and the learnt clauses stay valid while the netlist is only simplified,
+// so the engines are kept across fraig runs; a removed gate (merged or
+// swept) loses its variable, since its id may be reused. The engine also
+// holds the scratch of the truth-table check of its worker.
+struct ProofEngine
+{
+	ProofEngine() : minterm(0), byTruth(false) {
+		solver.initialize();
+		table.push_back(solver.newVar());
+		solver.assertProperty(table[0], false);
+	}
+
+	SatSolver           solver;
+	SatTable            table;     // [gate id] -> Var, var_Undef if not encoded
+	IdList              sup;       // PIs of the last pair decided by truth tables
+	unsigned            minterm;   // bit i is sup[i] in its distinguishing pattern
+	bool                byTruth;   // the last pair was decided by truth tables
+};
+
+// A class member to be proved against the representative of its class
+struct FraigCand
+{
+	FraigCand(unsigned v, unsigned k, unsigned l) : level(v), rep(k), lit(l) {}
+	bool operator < (const FraigCand& c) const { return level < c.level; }
+
+	unsigned            level;     // logic level of the member
+	unsigned            rep;
+	unsigned            lit;
+};
+
+// State of one fraig worker. Its engine is kept across rounds; the results
+// of a round are committed by the main thread.
+struct FraigJob
+{
+	FraigJob(const CirMgr* m, unsigned w, ProofEngine* e)
+		: mgr(m), worker(w), workers(1), window(0), engine(*e), satNum(0), ttNum(0), timedOut(false) {}
+
+	const CirMgr*       mgr;
+	unsigned            worker;    // handles pairs worker, worker+workers, ... of the window
+	unsigned            workers;
+	const vector<FraigCand>* window;  // pairs of the current round
+	ProofEngine&        engine;
+	IdList              stack;
+	unsigned            satNum;
+	unsigned            ttNum;     // pairs decided by truth tables
+	IdList              merges;    // pairs of the window proved equal
+	IdList              skipped;   // pairs of the window left open by the SAT budget
+	bool                timedOut;  // stopped by the time limit of the command
+	vector<vector<char> > cexs;    // PI values of the disproved pairs, -1 if not encoded
+};
+
+// Orders literals by the level of their gates
+struct LevelLess
+{
+	LevelLess(const IdList& l) : level(l) {}
+	bool operator () (unsigned a, unsigned b) const { return level[a/2] < level[b/2]; }
+
+	const IdList&       level;
+};
+
+// Orders classes by the level of their representatives
+struct ClassLess
+{
+	ClassLess(const IdList& l) : level(l) {}
+	bool operator () (const IdList& a, const IdList& b) const { return level[a[0]/2] < level[b[0]/2]; }
+
+	const IdList&       level;
+};
 
 /**************************************/
 /*   Static varaibles and functions   */
 /**************************************/
+// Word w of the truth table of input v of a cone
+static inline SimWord
+ttVar(unsigned v, unsigned w)
+{
+	static const SimWord mask[6] = {
+		0xaaaaaaaaaaaaaaaaULL, 0xccccccccccccccccULL, 0xf0f0f0f0f0f0f0f0ULL,
+		0xff00ff00ff00ff00ULL, 0xffff0000ffff0000ULL, 0xffffffff00000000ULL };
+	if (v < 6) return mask[v];
+	return ((w >> (v-6)) & 1)? ~(SimWord)0 : 0;
+}
+
+// Words of a truth table over n inputs
+static inline unsigned
+ttWords(unsigned n)
+{
+	return (n <= 6)? 1 : 1u << (n-6);
+}
+
+// Truth table "dst" over the sorted inputs "to" of the table "src" over the
+// sorted inputs "from", which are a subset of them
+static void
+ttExpand(const SimWord* src, const unsigned* from, unsigned nf,
+         SimWord* dst, const unsigned* to, unsigned nt)
+{
+	unsigned words = ttWords(nt);
+	if (nf == nt){
+		for (unsigned w = 0; w < words; w++) dst[w] = src[w];
+		return;
+	}
+	unsigned at[TT_VARS];
+	for (unsigned i = 0, k = 0; i < nf; i++){
+		while (to[k] != from[i]) k++;
+		at[i] = k;
+	}
+	for (unsigned w = 0; w < words; w++){
+		SimWord t = 0;
+		for (unsigned b = 0; b < SIM_WORD_BITS; b++){
+			unsigned m = w*SIM_WORD_BITS + b, x = 0;
+			for (unsigned i = 0; i < nf; i++) x |= ((m >> at[i]) & 1) << i;
+			t |= ((src[x/SIM_WORD_BITS] >> (x%SIM_WORD_BITS)) & 1) << b;
+		}
+		dst[w] = t;
+	}
+}
+
+// All-one mask for a complemented class member
+static inline SimWord
+phase(bool inv)
+{
+	return inv ? ~(SimWord)0 : 0;
+}
+
+// 64-bit hash of the phase-normalized words of a gate in the last round
+static SimWord
+hashWords(const SimWord* v, bool inv, const SimWord* used)
+{
+	SimWord h = 0x9e3779b97f4a7c15ULL;
+	for (unsigned w = 0; w < SIM_WORDS; w++){
+		h ^= (v[w] ^ phase(inv)) & used[w];
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 32;
+	}
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	return h ^ (h >> 33);
+}
+
+static bool
+equalWords(const SimWord* a, const SimWord* b, bool inv, const SimWord* used)
+{
+	for (unsigned w = 0; w < SIM_WORDS; w++)
+		if ((a[w] ^ b[w] ^ phase(inv)) & used[w]) return false;
+	return true;
+}
 
 /*******************************************/
 /*   Public member functions about fraig   */
@@ -29,107 +173,611 @@ using namespace std;
 void
 CirMgr::strash()
 {
-	if (_DFS->empty())
-		for (GateList::iterator i = _POs->begin(); i != _POs->end(); i++)
-			DFScheck(i->second);
+	buildDFS();
 	clock_t c;
 	c = clock();
-	Hash<HashKey, CirGate*> hashTable(32);
-	for (GateVList::iterator j = _DFS->begin(); j != _DFS->end(); j++){
-		if ((*j)->_type == PO_GATE || (*j)->_type == PI_GATE) continue;
-		HashKey key((*j)->getFanin());
-		CirGate* mergeGate;
-		if (hashTable.check(key, mergeGate)){
-			if (mergeGate != *j){
-				cout << "Merging " << (*j)->getIndex() << " and " << mergeGate->getIndex() << endl;
-				mergeGate->merge(*j);
-			}
+	_strash.init(_dfsList.size());
+	for (IdList::iterator j = _dfsList.begin(); j != _dfsList.end(); j++){
+		if (_types[*j] != AIG_GATE) continue;
+		unsigned left = _fanin0[*j] = resolve(_fanin0[*j]);
+		unsigned right = _fanin1[*j] = resolve(_fanin1[*j]);
+		unsigned mergeId;
+		if (_strash.check(left, right, mergeId)){
+			cout << "Merging " << *j << " and " << mergeId << endl;
+			merge(*j, mergeId*2);
 		}
-		else hashTable.forceInsert(key, *j);
+		else _strash.insert(left, right, *j);
 	}
+	_strashValid = true;
+	cleanup();
 	cout << "Strash takes " << float(clock()-c)/CLOCKS_PER_SEC << " seconds.\n";
 }
 
+// Every class is proved against its shallowest member, so a gate is always
+// merged into one that is not in its transitive fanout. Members are
+// literals, and a complemented member is merged with the inversion.
+// A pair whose cones have at most TT_VARS PIs together is decided by
+// exact truth tables without a SAT call. Otherwise CNF is only generated
+// for the fanin cones of the compared gates, and the engines keep it with
+// their learnt clauses for the next fraig.
+// The PI values of every disproved pair are collected; each SIM_WORD_BITS
+// of them are simulated at once to split all classes, and the scan then
+// restarts on the refined classes.
+// With more than one thread the classes are proved by fraigParallel().
+// A pair whose SAT call runs out of its conflict or propagation budget is
+// skipped: the member stays in the netlist and leaves its class. Once the
+// time limit is reached the remaining pairs are skipped as well.
 void
-CirMgr::fraig()
+CirMgr::fraig(unsigned threads)
 {
-	clock_t c;
-	GateList::iterator i;
-	FEClist::iterator j;
-	GateVList::iterator k, l;
-	SatSolver solver;
-	SatTable table;
-	c = clock();
-	solver.initialize();
-	resetMark(false);
-	for (i = _POs->begin(); i != _POs->end(); i++)
-		DFSinitSAT(i->second, solver, table);
-	for (j = _FECgroups.begin(); j != _FECgroups.end(); j++){
-		if (j->second.size() <= 1) continue;
-		k = j->second.begin();
-		while (k != j->second.end()){
-			l = k+1;
-			while (l != j->second.end()){
-				if (j->second.size() <= 1) break;
-				if (solveSAT(table[*k], table[*l], solver)){
-					cout << (*k)->getIndex() << " and " << (*l)->getIndex() << " are equivalent pair.\n";
-					(*k)->merge(*l);
-					l = j->second.erase(l);
-				}
-				else l++;
-			}
-			k = j->second.erase(k);
-			if (j->second.size() <= 1) break;
-		}
-	}
-	cout << "FRAIG takes " << float(clock()-c)/CLOCKS_PER_SEC << " seconds.\n";
+	double c;   // wall-clock: clock() adds up the CPU time of all workers
+	unsigned satNum = 0, ttNum = 0, resimNum = 0, skipNum = 0;
+	IdList level;
+	c = realTime();
+	_deadline = (_timeLimit > 0)? c + _timeLimit : 0;
+	buildLevel(level);
+	buildSupport();
+	if (threads > 1) fraigParallel(threads, level, satNum, ttNum, resimNum, skipNum);
+	else fraigSerial(level, satNum, ttNum, resimNum, skipNum);
+	cleanup();
+	_FECgroups.clear();
+	_fecOf.clear();
+	_fecInit = false;
+	_supNum.clear();
+	_supList.clear();
+	_supTT.clear();
+	_deadline = 0;
+	cout << satNum << " SAT calls, " << resimNum << " resimulation rounds.\n";
+	if (ttNum > 0) cout << ttNum << " pairs decided by truth tables.\n";
+	if (skipNum > 0) cout << skipNum << " pairs skipped.\n";
+	cout << "FRAIG takes " << realTime()-c << " seconds.\n";
 }
 
 /********************************************/
 /*   Private member functions about fraig   */
 /********************************************/
 
+// The pairs of all classes are proved from the lowest level up, and each
+// proved member is merged at once, so the cones of deeper pairs are encoded
+// through the representatives of the gates already merged.
 void
-CirMgr::collectFEC()
+CirMgr::fraigSerial(const IdList& level, unsigned& satNum, unsigned& ttNum, unsigned& resimNum,
+                    unsigned& skipNum)
 {
-	_FECgroups.clear();
-	for (GateList::iterator i = _ANDs->begin(); i != _ANDs->end(); i++)
-   	_FECgroups[i->second->_value_str].push_back(i->second);
+	ProofEngine* e = getEngine(0);
+	SatSolver& solver = e->solver;
+	SatTable& table = e->table;
+	vector<SimWord> cex(_piList.size(), 0);
+	vector<FraigCand> cand;
+	vector<bool> skip(_gates.size(), false);
+	unsigned cexNum = 0;
+	while (!_FECgroups.empty()){
+		levelFEC(level);
+		cand.clear();
+		for (FEClist::iterator j = _FECgroups.begin(); j != _FECgroups.end(); j++)
+			for (size_t m = 1; m < j->size(); m++)
+				cand.push_back(FraigCand(level[(*j)[m]/2], (*j)[0], (*j)[m]));
+		stable_sort(cand.begin(), cand.end());
+		size_t c;
+		bool timedOut = false;
+		for (c = 0; c < cand.size(); c++){
+			if (timeUp()){ timedOut = true; break; }
+			unsigned k = cand[c].rep, l = cand[c].lit;
+			bool inv = (k ^ l) & 1;
+			int r = truthCheck(k, l, *e);
+			if (r >= 0) ttNum++;
+			else {
+				satNum++;
+				encodeCone(k/2, solver, table, _dfsStack);
+				encodeCone(l/2, solver, table, _dfsStack);
+				r = solveSAT(table[k/2], table[l/2], inv, solver);
+			}
+			if (r == 1){
+				cout << k/2 << " and " << (inv?"!":"") << l/2 << " are equivalent pair.\n";
+				merge(l/2, (k & ~1u) | inv);
+				continue;
+			}
+			if (r < 0){
+				cout << k/2 << " and " << (inv?"!":"") << l/2 << " are skipped pair.\n";
+				skip[l/2] = true;
+				skipNum++;
+				continue;
+			}
+			// PIs outside the compared cones get random values
+			for (unsigned i = 0; i < _piList.size(); i++){
+				int v = cexValue(*e, _piList[i]);
+				if ((v >= 0)? v : (my_random() & 1))
+					cex[i] |= (SimWord)1 << cexNum;
+			}
+			if (++cexNum == SIM_WORD_BITS) break;
+		}
+		if (timedOut){
+			cout << "FRAIG time limit reached, " << cand.size()-c << " pairs left.\n";
+			skipNum += cand.size()-c;
+			break;
+		}
+		dropFEC(skip);
+		purgeFEC();
+		// Every disproved pair is split by its own counterexample
+		if (cexNum > 0){
+			resimulate(cex, cexNum);
+			resimNum++;
+			cex.assign(_piList.size(), 0);
+			cexNum = 0;
+		}
+	}
 }
 
+// The pairs are proved in windows of one member level, from the lowest up.
+// A pair only reads gates below the level of its member, and the pairs
+// below the window are done, so the workers prove the window in parallel
+// with their own solvers on the netlist with all the lower merges applied,
+// as fraigSerial() does. A worker stops after SIM_WORD_BITS
+// counterexamples. The main thread then commits the merges in window order,
+// so the result does not depend on thread timing. The counterexamples are
+// resimulated once SIM_WORD_BITS of them are collected or all windows are
+// done, and the scan restarts on the refined classes.
 void
-CirMgr::DFSinitSAT(CirGate* g, SatSolver& s, SatTable& t)
+CirMgr::fraigParallel(unsigned threads, const IdList& level, unsigned& satNum, unsigned& ttNum,
+                      unsigned& resimNum, unsigned& skipNum)
 {
-	g->_mark = true;
-	switch (g->_type){
-		case PO_GATE:
-			if (!g->input()->_mark) DFSinitSAT(g->input(), s, t);
-			break;
-		case AIG_GATE:
-			t.insert(pair<CirGate*, Var>(g, s.newVar()));
-			if (!g->left_input()->_mark) DFSinitSAT(g->left_input(), s, t);
-			if (!g->right_input()->_mark) DFSinitSAT(g->right_input(), s, t);
-			s.addAigCNF(t[g], t[g->left_input()], g->left_inverted(), t[g->right_input()], g->right_inverted());
-			break;
-		case PI_GATE:
-			t.insert(pair<CirGate*, Var>(g, s.newVar()));
+	vector<FraigJob*> jobs;
+	vector<pthread_t> tids(threads);
+	for (unsigned w = 0; w < threads; w++)
+		jobs.push_back(new FraigJob(this, w, getEngine(w)));
+	vector<FraigCand> cand, window;
+	IdList merges, skipped;
+	vector<vector<char> > cexs;
+	vector<bool> skip(_gates.size(), false);
+	while (!_FECgroups.empty()){
+		levelFEC(level);
+		cand.clear();
+		for (FEClist::iterator j = _FECgroups.begin(); j != _FECgroups.end(); j++)
+			for (size_t m = 1; m < j->size(); m++)
+				cand.push_back(FraigCand(level[(*j)[m]/2], (*j)[0], (*j)[m]));
+		stable_sort(cand.begin(), cand.end());
+		cexs.clear();
+		bool timedOut = false;
+		for (size_t c = 0; c < cand.size() && cexs.size() < SIM_WORD_BITS && !timedOut; ){
+			window.clear();
+			for (unsigned front = cand[c].level; c < cand.size() && cand[c].level == front; c++)
+				window.push_back(cand[c]);
+
+			// Small windows are proved here without starting threads
+			unsigned workers = (window.size() < threads)? window.size() : threads, running = 0;
+			for (unsigned w = 0; w < workers; w++){
+				jobs[w]->workers = workers;
+				jobs[w]->window = &window;
+			}
+			if (workers > 1)
+				for (; running < workers; running++)
+					if (pthread_create(&tids[running], NULL, fraigThread, jobs[running]) != 0) break;
+			// Workers that failed to start are run here
+			for (unsigned w = running; w < workers; w++) fraigThread(jobs[w]);
+			for (unsigned w = 0; w < running; w++) pthread_join(tids[w], NULL);
+
+			merges.clear(); skipped.clear();
+			for (unsigned w = 0; w < workers; w++){
+				FraigJob& j = *jobs[w];
+				satNum += j.satNum;
+				ttNum += j.ttNum;
+				timedOut |= j.timedOut;
+				merges.insert(merges.end(), j.merges.begin(), j.merges.end());
+				skipped.insert(skipped.end(), j.skipped.begin(), j.skipped.end());
+				cexs.insert(cexs.end(), j.cexs.begin(), j.cexs.end());
+				j.satNum = j.ttNum = 0; j.merges.clear(); j.skipped.clear(); j.cexs.clear();
+				j.timedOut = false;
+			}
+			sort(merges.begin(), merges.end());
+			for (size_t i = 0; i < merges.size(); i++){
+				unsigned k = window[merges[i]].rep, l = window[merges[i]].lit;
+				bool inv = (k ^ l) & 1;
+				cout << k/2 << " and " << (inv?"!":"") << l/2 << " are equivalent pair.\n";
+				merge(l/2, (k & ~1u) | inv);
+			}
+			sort(skipped.begin(), skipped.end());
+			for (size_t i = 0; i < skipped.size(); i++){
+				unsigned k = window[skipped[i]].rep, l = window[skipped[i]].lit;
+				cout << k/2 << " and " << (((k ^ l) & 1)?"!":"") << l/2 << " are skipped pair.\n";
+				skip[l/2] = true;
+			}
+			skipNum += skipped.size();
+		}
+		dropFEC(skip);
+		purgeFEC();
+		if (timedOut){
+			unsigned left = 0;
+			for (size_t g = 0; g < _FECgroups.size(); g++) left += _FECgroups[g].size()-1;
+			cout << "FRAIG time limit reached, " << left << " pairs left.\n";
+			skipNum += left;
 			break;
-		case CONST_GATE:{
-			t.insert(pair<CirGate*, Var>(g, s.newVar()));
-			Var vir = s.newVar();
-			s.addAigCNF(t[g], vir, true, vir, false);
-			break;}
-		case UNDEF_GATE:
-		default: break;
+		}
+		// PIs outside the compared cones get random values
+		vector<SimWord> cex(_piList.size(), 0);
+		for (size_t b = 0; b < cexs.size(); b += SIM_WORD_BITS){
+			unsigned n = (cexs.size()-b < SIM_WORD_BITS)? cexs.size()-b : SIM_WORD_BITS;
+			cex.assign(_piList.size(), 0);
+			for (unsigned p = 0; p < n; p++)
+				for (unsigned i = 0; i < _piList.size(); i++){
+					char v = cexs[b+p][i];
+					if ((v >= 0)? v : (my_random() & 1)) cex[i] |= (SimWord)1 << p;
+				}
+			resimulate(cex, n);
+			resimNum++;
+		}
+	}
+	for (unsigned w = 0; w < threads; w++) delete jobs[w];
+}
+
+// Prove the pairs of one worker in the window against their representatives
+void
+CirMgr::provePairs(FraigJob& j) const
+{
+	const vector<FraigCand>& window = *j.window;
+	ProofEngine& e = j.engine;
+	for (unsigned c = j.worker; c < window.size() && j.cexs.size() < SIM_WORD_BITS; c += j.workers){
+		unsigned k = window[c].rep, l = window[c].lit;
+		if (timeUp()){ j.timedOut = true; return; }
+		int r = truthCheck(k, l, e);
+		if (r >= 0) j.ttNum++;
+		else {
+			j.satNum++;
+			encodeCone(k/2, e.solver, e.table, j.stack);
+			encodeCone(l/2, e.solver, e.table, j.stack);
+			r = solveSAT(e.table[k/2], e.table[l/2], (k ^ l) & 1, e.solver);
+		}
+		if (r == 1){
+			j.merges.push_back(c);
+			continue;
+		}
+		if (r < 0){
+			j.skipped.push_back(c);
+			continue;
+		}
+		j.cexs.push_back(vector<char>(_piList.size()));
+		vector<char>& v = j.cexs.back();
+		for (unsigned i = 0; i < _piList.size(); i++)
+			v[i] = cexValue(e, _piList[i]);
+	}
+}
+
+void*
+CirMgr::fraigThread(void* arg)
+{
+	FraigJob* j = (FraigJob*)arg;
+	j->mgr->provePairs(*j);
+	return NULL;
+}
+
+// Simulate n counterexample patterns (bit i of cex[k] is PI k in the i-th
+// pattern) and split the FEC classes with them
+void
+CirMgr::resimulate(const vector<SimWord>& cex, unsigned n)
+{
+	if (_simValue.size() != _gates.size()*SIM_WORDS)
+		_simValue.assign(_gates.size()*SIM_WORDS, 0);
+	buildDFS();
+	for (unsigned i = 0; i < _piList.size(); i++){
+		_simValue[_piList[i]*SIM_WORDS] = cex[i];
+		for (unsigned w = 1; w < SIM_WORDS; w++)
+			_simValue[_piList[i]*SIM_WORDS+w] = 0;
+	}
+	simulate(n);
+	refineFEC();
+}
+
+// Before any pattern is applied the constant and all AIG gates form one
+// class; their phases are fixed by the first pattern in refineFEC()
+void
+CirMgr::initFEC()
+{
+	_FECgroups.clear();
+	IdList all(1, 0);
+	for (IdList::iterator i = _dfsList.begin(); i != _dfsList.end(); i++)
+		if (_types[*i] == AIG_GATE) all.push_back(*i*2);
+	if (all.size() > 1){
+		_FECgroups.push_back(IdList());
+		_FECgroups.back().swap(all);
 	}
+	indexFEC();
+	_simNum = 0;
+	_fecInit = true;
+	_fecPhase = false;
 }
 
+// Split every class by the phase-normalized words of the last round, so a
+// gate and the complement of another one stay in the same class. Members
+// are sorted by a 64-bit hash of their words, so only gates in the same
+// hash run are compared word by word, and keep their topological order.
+// Return true if any class was split.
 bool
-CirMgr::solveSAT(Var& a, Var& b, SatSolver& s)
+CirMgr::refineFEC()
+{
+	SimWord used[SIM_WORDS];
+	for (unsigned w = 0; w < SIM_WORDS; w++){
+		if (_roundNum >= (w+1)*SIM_WORD_BITS) used[w] = ~(SimWord)0;
+		else if (_roundNum <= w*SIM_WORD_BITS) used[w] = 0;
+		else used[w] = ((SimWord)1 << (_roundNum%SIM_WORD_BITS)) - 1;
+	}
+	const SimWord* val = &_simValue[0];
+	if (!_fecPhase){
+		for (FEClist::iterator j = _FECgroups.begin(); j != _FECgroups.end(); j++)
+			for (IdList::iterator i = j->begin(); i != j->end(); i++)
+				*i = (*i & ~1u) | (val[*i/2*SIM_WORDS] & 1);
+		_fecPhase = true;
+	}
+	bool split = false;
+	FEClist refined;
+	vector<pair<SimWord, unsigned> > keys;     // (hash, position in the class)
+	for (FEClist::iterator j = _FECgroups.begin(); j != _FECgroups.end(); j++){
+		IdList& grp = *j;
+		keys.clear();
+		for (unsigned k = 0; k < grp.size(); k++)
+			keys.push_back(make_pair(hashWords(val + grp[k]/2*SIM_WORDS, grp[k]&1, used), k));
+		sort(keys.begin(), keys.end());
+		size_t before = refined.size();
+		for (size_t b = 0, e = 0; b < keys.size(); b = e){
+			for (e = b+1; e < keys.size() && keys[e].first == keys[b].first; e++) ;
+			size_t first = refined.size();
+			for (size_t k = b; k < e; k++){
+				unsigned lit = grp[keys[k].second];
+				size_t g = first;
+				while (g < refined.size() && !equalWords(val + refined[g][0]/2*SIM_WORDS, val + lit/2*SIM_WORDS,
+				                                         (refined[g][0] ^ lit) & 1, used)) g++;
+				if (g == refined.size()) refined.push_back(IdList());
+				refined[g].push_back(lit);
+			}
+		}
+		if (refined.size()-before > 1) split = true;
+	}
+	size_t n = 0;
+	for (size_t g = 0; g < refined.size(); g++)
+		if (refined[g].size() > 1) refined[n++].swap(refined[g]);
+	refined.resize(n);
+	_FECgroups.swap(refined);
+	indexFEC();
+	return split;
+}
+
+// Move the shallowest member of every class to the front, keeping the
+// topological order among members of the same level, and order the classes
+// by the level of their representatives
+void
+CirMgr::levelFEC(const IdList& level)
+{
+	for (FEClist::iterator j = _FECgroups.begin(); j != _FECgroups.end(); j++)
+		stable_sort(j->begin(), j->end(), LevelLess(level));
+	stable_sort(_FECgroups.begin(), _FECgroups.end(), ClassLess(level));
+	indexFEC();
+}
+
+// Drop the members flagged in "skip"; classes left with one member are
+// removed by purgeFEC()
+void
+CirMgr::dropFEC(const vector<bool>& skip)
+{
+	for (FEClist::iterator j = _FECgroups.begin(); j != _FECgroups.end(); j++){
+		unsigned m = 0;
+		for (unsigned k = 0; k < j->size(); k++)
+			if (!skip[(*j)[k]/2]) (*j)[m++] = (*j)[k];
+		j->resize(m);
+	}
+}
+
+// Drop removed or merged gates from the classes
+void
+CirMgr::purgeFEC()
+{
+	size_t n = 0;
+	for (size_t g = 0; g < _FECgroups.size(); g++){
+		IdList& grp = _FECgroups[g];
+		unsigned m = 0;
+		for (unsigned k = 0; k < grp.size(); k++){
+			unsigned id = grp[k]/2;
+			if (_gates[id] != NULL && _repl[id] == id*2) grp[m++] = grp[k];
+		}
+		grp.resize(m);
+		if (m > 1) _FECgroups[n++].swap(grp);
+	}
+	_FECgroups.resize(n);
+	indexFEC();
+}
+
+void
+CirMgr::indexFEC()
+{
+	_fecOf.assign(_gates.size(), NO_FEC);
+	for (unsigned g = 0; g < _FECgroups.size(); g++)
+		for (IdList::iterator i = _FECgroups[g].begin(); i != _FECgroups[g].end(); i++)
+			_fecOf[*i/2] = g;
+}
+
+// Engine of worker w, created on first use; its table covers all gate ids
+ProofEngine*
+CirMgr::getEngine(unsigned w)
 {
-	Var f = s.newVar();
-	s.addXorCNF(f, a, false, b, false);
+	while (_engines.size() <= w) _engines.push_back(new ProofEngine);
+	ProofEngine* e = _engines[w];
+	if (e->table.size() < _gates.size())
+		e->table.resize(_gates.size(), var_Undef);
+	return e;
+}
+
+void
+CirMgr::resetEngines()
+{
+	for (size_t w = 0; w < _engines.size(); w++) delete _engines[w];
+	_engines.clear();
+}
+
+// The clauses of the gate stay in the solvers and keep constraining only
+// their own variable; the id may be reused by a different gate
+void
+CirMgr::forgetVar(unsigned id)
+{
+	for (size_t w = 0; w < _engines.size(); w++)
+		if (id < _engines[w]->table.size()) _engines[w]->table[id] = var_Undef;
+}
+
+// Sorted PIs of the cone of every gate in the DFS order, computed from the
+// supports of the fanins; a gate with more than TT_VARS of them only gets
+// the count TT_VARS+1. A gate with a small support also gets its truth
+// table over it, from the tables of its fanins. The fanins are not changed
+// until the final cleanup of fraig, so both stay valid for the whole run.
+void
+CirMgr::buildSupport()
+{
+	buildDFS();
+	_supNum.assign(_gates.size(), TT_VARS+1);
+	_supList.assign(_gates.size()*TT_VARS, 0);
+	_supTT.assign(_gates.size()*TT_WORDS, 0);
+	_supNum[0] = 0;
+	for (IdList::iterator it = _dfsList.begin(); it != _dfsList.end(); it++){
+		unsigned id = *it, n = 0;
+		unsigned* s = &_supList[id*TT_VARS];
+		SimWord* t = &_supTT[id*TT_WORDS];
+		if (_types[id] == PI_GATE){
+			s[n++] = id;
+			t[0] = ttVar(0, 0);
+		}
+		else if (_types[id] == AIG_GATE){
+			unsigned a = _fanin0[id]/2, b = _fanin1[id]/2;
+			unsigned na = _supNum[a], nb = _supNum[b];
+			if (na > TT_VARS || nb > TT_VARS) continue;
+			const unsigned* sa = &_supList[a*TT_VARS], *sb = &_supList[b*TT_VARS];
+			unsigned i = 0, j = 0;
+			while ((i < na || j < nb) && n <= TT_VARS){
+				unsigned x;
+				if (j == nb || (i < na && sa[i] < sb[j])) x = sa[i++];
+				else if (i == na || sb[j] < sa[i]) x = sb[j++];
+				else { x = sa[i++]; j++; }
+				if (n == TT_VARS){ n++; break; }
+				s[n++] = x;
+			}
+			if (n > TT_VARS) continue;
+			SimWord ta[TT_WORDS], tb[TT_WORDS];
+			ttExpand(&_supTT[a*TT_WORDS], sa, na, ta, s, n);
+			ttExpand(&_supTT[b*TT_WORDS], sb, nb, tb, s, n);
+			SimWord pa = phase(_fanin0[id] & 1), pb = phase(_fanin1[id] & 1);
+			for (unsigned w = 0; w < ttWords(n); w++)
+				t[w] = (ta[w] ^ pa) & (tb[w] ^ pb);
+		}
+		else if (_types[id] == PO_GATE) continue;
+		_supNum[id] = n;
+	}
+}
+
+// Decide the pair of literals a and b by their truth tables from
+// buildSupport(), mapped onto the PIs of both, if there are at most TT_VARS
+// of them. Return 1 if they are equal, 0 if they differ (e.sup and
+// e.minterm then give a distinguishing pattern) and -1 if the support is
+// too large.
+int
+CirMgr::truthCheck(unsigned a, unsigned b, ProofEngine& e) const
+{
+	e.byTruth = false;
+	unsigned na = _supNum[a/2], nb = _supNum[b/2];
+	if (na > TT_VARS || nb > TT_VARS) return -1;
+	const unsigned* sa = &_supList[a/2*TT_VARS], *sb = &_supList[b/2*TT_VARS];
+	e.sup.clear();
+	unsigned i = 0, j = 0;
+	while (i < na || j < nb){
+		if (j == nb || (i < na && sa[i] < sb[j])) e.sup.push_back(sa[i++]);
+		else if (i == na || sb[j] < sa[i]) e.sup.push_back(sb[j++]);
+		else { e.sup.push_back(sa[i++]); j++; }
+	}
+	if (e.sup.size() > TT_VARS) return -1;
+
+	SimWord ta[TT_WORDS], tb[TT_WORDS];
+	const unsigned* sup = e.sup.empty()? NULL : &e.sup[0];
+	ttExpand(&_supTT[a/2*TT_WORDS], sa, na, ta, sup, e.sup.size());
+	ttExpand(&_supTT[b/2*TT_WORDS], sb, nb, tb, sup, e.sup.size());
+	e.byTruth = true;
+	for (unsigned w = 0; w < ttWords(e.sup.size()); w++){
+		SimWord d = ta[w] ^ tb[w] ^ phase((a ^ b) & 1);
+		if (d){
+			e.minterm = w*SIM_WORD_BITS + __builtin_ctzll(d);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+// Value of PI "id" in the counterexample of the last pair of engine e, or
+// -1 if the PI is not in the compared cones
+int
+CirMgr::cexValue(const ProofEngine& e, unsigned id) const
+{
+	if (e.byTruth){
+		for (unsigned i = 0; i < e.sup.size(); i++)
+			if (e.sup[i] == id) return (e.minterm >> i) & 1;
+		return -1;
+	}
+	Var v = e.table[id];
+	return (v != var_Undef)? e.solver.getValue(v) : -1;
+}
+
+// Encode the not yet encoded part of the fanin cone of "root"; fanins are
+// encoded before their fanouts. Fanins are taken through the merges made so
+// far. Only reads the netlist, so workers can run it concurrently with
+// their own solver, table and stack. UNDEF gates share the variable of the
+// constant, which must be encoded first. Each new variable first tries the
+// value of its gate in the first pattern of the last simulation round, so
+// the search starts from a real circuit state.
+void
+CirMgr::encodeCone(unsigned root, SatSolver& s, SatTable& t, IdList& stack) const
+{
+	if (t[root] != var_Undef) return;
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty()){
+		unsigned id = stack.back();
+		unsigned in0 = 0, in1 = 0;
+		if (_types[id] == AIG_GATE){
+			in0 = follow(_fanin0[id]);
+			in1 = follow(_fanin1[id]);
+			if (t[in0/2] == var_Undef){ stack.push_back(in0/2); continue; }
+			if (t[in1/2] == var_Undef){ stack.push_back(in1/2); continue; }
+		}
+		stack.pop_back();
+		switch (_types[id]){
+			case AIG_GATE:
+				t[id] = s.newVar();
+				s.addAigCNF(t[id], t[in0/2], in0%2, t[in1/2], in1%2);
+				s.setPolarity(t[id], getSimWord(id, 0) & 1);
+				break;
+			case PI_GATE:
+				t[id] = s.newVar();
+				s.setPolarity(t[id], getSimWord(id, 0) & 1);
+				break;
+			case UNDEF_GATE:
+			default:
+				t[id] = t[0];
+				break;
+		}
+	}
+}
+
+// The miter is guarded by a fresh activation variable and retired after the
+// call, so no dead miter clauses stay active in the solver.
+// Return 1 if the pair is equivalent, 0 if the solver found a
+// counterexample and -1 if the budget of the call or the time limit of
+// the command ran out.
+int
+CirMgr::solveSAT(Var& a, Var& b, bool inv, SatSolver& s) const
+{
+	Var act = s.newVar();
+	s.addMiterCNF(act, a, b, inv);
 	s.assumeRelease();
-	s.assumeProperty(f, true);
-	return !s.assumpSolve();
-}
\ No newline at end of file
+	s.assumeProperty(act, true);
+	s.setBudget(_confLimit, _propLimit, _deadline);
+	int sat = s.assumpSolveLimited();
+	s.assertProperty(act, false);
+	return (sat < 0)? -1 : !sat;
+}
+
+bool
+CirMgr::timeUp() const
+{
+	return _deadline > 0 && realTime() >= _deadline;
+}
@@ -23,6 +23,9 @@ extern CirMgr *cirMgr;
 /*   class CirGate member functions   */
 /**************************************/
 
+// Gates are created with _ref 0, so they start out unmarked
+unsigned CirGate::_globalRef = 1;
+
 string CirGate::getTypeStr() const {
 	switch (_type){
 		case PI_GATE: return "PI"; break;
@@ -37,29 +40,31 @@ string CirGate::getTypeStr() const {
 void CirGate::reportGate() const {
    string n;
    n = (_name.compare("") == 0)?"":("\""+_name+"\"");
-   GateVList::const_iterator it;
-   string values = _value_str;
+   IdList::const_iterator it;
+   const IdList* fec;
 	switch (_type){
 		case PI_GATE:
          cout << "PI(" << _index << ")" << n << ", line " << _line << endl;
-         cout << "Value: " << _value_str << endl;
+         cout << "Value: " << getSimStr() << endl;
          break;
 		case PO_GATE:
          cout << "PO(" << _index << ")" << n << ", line " << _line << endl;
-         cout << "Value: " << _value_str << endl;
+         cout << "Value: " << getSimStr() << endl;
          break;
       case AIG_GATE:
          cout << "AIG(" << _index << "), line " << _line << endl;
          cout << "FECs:";
-         for (it = cirMgr->_FECgroups[values].begin(); it != cirMgr->_FECgroups[values].end(); it++){
-            if ((*it)->getIndex() == _index) continue;
-            else cout << " " << (*it)->getIndex();
+         fec = cirMgr->getFEC(_index);
+         if (fec != NULL){
+            unsigned self = 0;
+            for (it = fec->begin(); it != fec->end(); it++)
+               if (*it/2 == _index) self = *it;
+            for (it = fec->begin(); it != fec->end(); it++){
+               if (*it == self) continue;
+               else cout << " " << (((*it ^ self) & 1)?"!":"") << *it/2;
+            }
          }
-         for (unsigned i = 0; i < values.size(); i++)
-            values[i] = (values[i] == '0')?'1':'0';
-         for (it = cirMgr->_FECgroups[values].begin(); it != cirMgr->_FECgroups[values].end(); it++)
-            cout << " !" << (*it)->getIndex();
-         cout << endl << "Value: " << _value_str << endl;
+         cout << endl << "Value: " << getSimStr() << endl;
          break;
 		case CONST_GATE: cout << "CONST(" << _index << "), line " << _line << endl; break;
 		case UNDEF_GATE :
@@ -67,175 +72,73 @@ void CirGate::reportGate() const {
 	}
 }
 
+// One character per pattern of the last simulation round
+string CirGate::getSimStr() const {
+   unsigned num = cirMgr->getRoundNum();
+   string str(num, '0');
+   for (unsigned i = 0; i < num; i++)
+      if ((cirMgr->getSimWord(_index, i/SIM_WORD_BITS) >> (i%SIM_WORD_BITS)) & 1) str[i] = '1';
+   return str;
+}
+
 void CirGate::reportFanin(int level) {
    assert (level >= 0);
-   cirMgr->resetMark(false);
-   DFSin(this, level, 0, false);
+   cirMgr->newTraversal();
+   DFSreport(level, true);
 }
 
 void CirGate::reportFanout(int level) {
    assert (level >= 0);
-   cirMgr->resetMark(false);
-   DFSout(this, level, 0, _index);
-}
-
-void CirGate::DFSin(CirGate* g, int level, int count, bool invert) {
-   string re = (g->_mark)?"(*)":"";
-   string inv = (invert && g->_type != CONST_GATE)?"!":"";
-   string tab(count*2, ' ');
-   cout << tab << inv << g->getTypeStr() << " " << g->getIndex() << re << endl;
-   if (g->_mark) return;
-   g->_mark = true;
-   if (level > count){
-      switch(g->_type){
-         case PO_GATE:
-            DFSin(g->input(), level, count+1, g->inverted());
-            break;
-         case AIG_GATE:
-            DFSin(g->left_input(), level, count+1, g->left_inverted());
-            DFSin(g->right_input(), level, count+1, g->right_inverted());
-            break;
-         case CONST_GATE:
-         case PI_GATE:
-         case UNDEF_GATE:
-         default: break;
+   cirMgr->newTraversal();
+   DFSreport(level, false);
+}
+
+// One pending gate of CirGate::DFSreport()
+struct ReportFrame { CirGate* g; int count; bool invert; };
+
+// Pre-order walk of the fanin (or fanout) cone with an explicit stack;
+// children are pushed in reverse so they are printed in their natural order.
+void CirGate::DFSreport(int level, bool fanin) {
+   vector<ReportFrame> stack;
+   ReportFrame f = { this, 0, false };
+   stack.push_back(f);
+   while (!stack.empty()){
+      f = stack.back();
+      stack.pop_back();
+      CirGate* g = f.g;
+      string re = (g->isMarked())?"(*)":"";
+      string inv = (f.invert && g->_type != CONST_GATE)?"!":"";
+      string tab(f.count*2, ' ');
+      cout << tab << inv << g->getTypeStr() << " " << g->getIndex() << re << endl;
+      if (g->isMarked()) continue;
+      g->setMark();
+      if (level <= f.count) continue;
+      unsigned id = g->getIndex();
+      if (fanin){
+         if (g->_type == AIG_GATE){
+            ReportFrame r = { g->right_input(), f.count+1, g->right_inverted() };
+            stack.push_back(r);
+         }
+         if (g->_type == AIG_GATE || g->_type == PO_GATE){
+            ReportFrame l = { g->left_input(), f.count+1, g->left_inverted() };
+            stack.push_back(l);
+         }
+      }
+      else {
+         for (unsigned i = cirMgr->getFanoutNum(id); i > 0; i--){
+            CirGate* out = cirMgr->getNode(cirMgr->getFanout(id, i-1));
+            bool outInv = (out->_type == PO_GATE)? out->inverted()
+                        : (out->left_input() == g)? out->left_inverted() : out->right_inverted();
+            ReportFrame o = { out, f.count+1, outInv };
+            stack.push_back(o);
+         }
       }
    }
 }
 
-void CirGate::DFSout(CirGate* g, int level, int count, unsigned index) {
-   bool invert = false;
-   switch(g->_type){
-      case PI_GATE:
-         invert = g->inverted(); break;
-      case AIG_GATE:
-         if (g->getFanin()->front()/2 == index) invert = g->left_inverted();
-         if (g->getFanin()->back()/2 == index) invert = g->left_inverted();
-         break;
-      case CONST_GATE:
-      case UNDEF_GATE:
-      case PO_GATE:
-      default: break;
-   }
-   string re = (g->_mark)?"(*)":"";
-   string inv = (invert && g->_type != CONST_GATE)?"!":"";
-   string tab(count*2, ' ');
-   cout << tab << inv << g->getTypeStr() << " " << g->getIndex() << re << endl;
-   if (g->_mark) return;
-   g->_mark = true;
-   if (level > count){
-      for (GateList::iterator it = g->output()->begin(); it != g->output()->end(); it++)
-         DFSout(it->second, level, count+1, it->first);
-   }
-}
-
-void CirGate::resetOutput(CirGate* victim, CirGate* target) {
-   _out->erase(victim->getIndex());
-   _out->insert(pair<unsigned, CirGate*>(target->getIndex(), target));
-}
-
-void CirGate::merge(CirGate* g) {
-   for (GateList::iterator it = g->output()->begin(); it != g->output()->end(); it++){
-      it->second->resetInput(g, this);
-      _out->insert(pair<unsigned, CirGate*>(it->first, it->second));
-   }
-}
-
-void conGate::gateRegist(unsigned id, CirGate* g) {
-   _out->insert(pair<unsigned, CirGate*>(id, g));
-}
-
-void conGate::unregist(unsigned id) {
-   _out->erase(id);
-}
-
-void iGate::gateRegist(unsigned id, CirGate* g) {
-   _out->insert(pair<unsigned, CirGate*>(id, g));
-}
-
-void iGate::unregist(unsigned id) {
-   _out->erase(id);
-}
-
-void oGate::resetInput(CirGate* victim, CirGate* target, bool inverted) {
-   if (_in == victim){
-      _in = target;
-      _invert = XOR(_invert,inverted);
-      (*_fanins)[0] = target->getIndex()*2 + (int)_invert;
-   }
-}
-
-void oGate::resetInput(CirGate* victim, CirGate* target) {
-   if (_in == victim){
-      _in = target;
-      (*_fanins)[0] = target->getIndex()*2 + (int)_invert;
-   }
-}
-
-void oGate::gateRegist(unsigned id, CirGate* g) {
-   if (_fanins->size() == 0){
-      _out->insert(pair<unsigned, CirGate*>(id, g));
-      return;
-   }
-   if (_fanins->back()/2 == id){
-      _in = g;
-      _invert = _fanins->back()%2;
-   }
-   else _out->insert(pair<unsigned, CirGate*>(id, g));
-}
-
-void oGate::unregist(unsigned id) {
-   if (_out->find(id) != _out->end())
-      _out->erase(id);
-   if (_in->getIndex() == id)
-      _in = NULL;
-}
-
-void andGate::resetInput(CirGate* victim, CirGate* target, bool inverted) {
-   if (_left_in == victim){
-      _left_in = target;
-      _left_invert = XOR(_left_invert,inverted);
-      (*_fanins)[0] = target->getIndex()*2 + (int)_left_invert;
-   }
-   if (_right_in == victim){
-      _right_in = target;
-      _right_invert = XOR(_right_invert, inverted);
-      (*_fanins)[1] = target->getIndex()*2 + (int)_right_invert;
-   }
-}
-
-void andGate::resetInput(CirGate* victim, CirGate* target) {
-   if (_left_in == victim){
-      (*_fanins)[0] = target->getIndex()*2 + (int)_left_invert;
-      _left_in = target;
-   }
-   if (_right_in == victim){
-      (*_fanins)[1] = target->getIndex()*2 + (int)_right_invert;
-      _right_in = target;
-   }
-}
-
-void andGate::gateRegist(unsigned id, CirGate* g) {
-   if (_fanins->size() == 0){
-      _out->insert(pair<unsigned, CirGate*>(id, g));
-      return;
-   }
-   if (_left_in == NULL && _fanins->front()/2 == id){
-      _left_in = g;
-      _left_invert = _fanins->front()%2;
-   }
-   else if (_right_in == NULL && _fanins->back()/2 == id){
-      _right_in = g;
-      _right_invert = _fanins->back()%2;
-   }
-   else _out->insert(pair<unsigned, CirGate*>(id, g));
-}
-
-void andGate::unregist(unsigned id) {
-   if (_out->find(id) != _out->end())
-      _out->erase(id);
-   if (_left_in->getIndex() == id)
-      _left_in = NULL;
-   if (_right_in->getIndex() == id)
-      _right_in = NULL;
-}
\ No newline at end of file
+CirGate* CirGate::input() const { return cirMgr->getNode(cirMgr->getFanin0(_index)/2); }
+bool CirGate::inverted() const { return cirMgr->getFanin0(_index)%2; }
+CirGate* CirGate::left_input() const { return cirMgr->getNode(cirMgr->getFanin0(_index)/2); }
+CirGate* CirGate::right_input() const { return cirMgr->getNode(cirMgr->getFanin1(_index)/2); }
+bool CirGate::left_inverted() const { return cirMgr->getFanin0(_index)%2; }
+bool CirGate::right_inverted() const { return cirMgr->getFanin1(_index)%2; }
@@ -12,6 +12,7 @@
 #include <ctype.h>
 #include <cassert>
 #include <cstring>
+#include <cstdlib>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "util.h"
@@ -155,8 +156,8 @@ bool CirMgr::readCircuit(const string& fileName) {
    string line;
 
    getline(f, line);
-   char head[3];
-   sscanf(line.c_str(), "%s%u%u%u%u%u", head, &M, &I, &L, &O, &A);
+   char head[16] = "";
+   sscanf(line.c_str(), "%15s%u%u%u%u%u", head, &M, &I, &L, &O, &A);
    int i = 0;
    while (head[i]) { head[i] = tolower(head[i]); i++; }
    string spec(head);
@@ -164,123 +165,287 @@ bool CirMgr::readCircuit(const string& fileName) {
    if (L != 0){ cerr << "[ERROR] I don\'t know how to deal with latches." << endl; return false; }
 
    resetlist();
-   for (unsigned index, i = 1; i <= I; i++){
+   unsigned n = M+O+1, lineNo = 1;
+   _gates.assign(n, NULL);
+   _types.assign(n, UNDEF_GATE);
+   _fanin0.assign(n, 0);
+   _fanin1.assign(n, 0);
+   addGate(CONST_GATE, 0, 0);
+   for (unsigned index, i = 0; i < I; i++){
       getline(f, line);
       sscanf(line.c_str(), "%u", &index);
-      iGate* newgate = new iGate(index);
-      newgate->setLineNo(i);
-      _PIs->insert(pair<unsigned, iGate*>(index/2, newgate));
+      addGate(PI_GATE, index/2, ++lineNo);
+      _piList.push_back(index/2);
    }
-   for (unsigned index, i = 1; i <= O; i++){
+   for (unsigned index, i = 0; i < O; i++){
       getline(f, line);
       sscanf(line.c_str(), "%u", &index);
-      oGate* newgate = new oGate(index);
-      newgate->setLineNo(i+I);
-      _POs->insert(pair<unsigned, oGate*>(index/2, newgate));
+      addGate(PO_GATE, M+1+i, ++lineNo);
+      _fanin0[M+1+i] = index;
+      _poList.push_back(M+1+i);
    }
-   for (unsigned index, l, r, i = 1; i <= A; i++){
+   // AIG gates are only recorded here and created by buildConnect()
+   IdList aigLine(n, 0);
+   for (unsigned index, l, r, i = 0; i < A; i++){
       getline(f, line);
       sscanf(line.c_str(), "%u%u%u", &index, &l, &r);
-      andGate* newgate = new andGate(index, l, r);
-      newgate->setLineNo(i+I+O);
-      _ANDs->insert(pair<unsigned, andGate*>(index/2, newgate));
+      _types[index/2] = AIG_GATE;
+      aigLine[index/2] = ++lineNo;
+      _fanin0[index/2] = l;
+      _fanin1[index/2] = r;
    }
 
-   while (!f.eof()){
-      getline(f, line);
-      if (line[0] == 'c' || line == "") break;
-      GateList* li;
-      if (line[0] == 'i') li = _PIs;
-      if (line[0] == 'o') li = _POs;
-      int count = line[1]-48;
-      string name = line.substr(line.find_first_of(' '), line.find_first_of('\n'));
-      GateList::iterator it = li->begin();
-      while (count != 0) { it++; count--;}
-      it->second->_name = name;
+   while (getline(f, line)){
+      if (line == "" || line[0] == 'c') break;
+      size_t sp = line.find_first_of(' ');
+      if (sp == string::npos) continue;
+      unsigned pos = atoi(line.c_str()+1);
+      if (line[0] == 'i' && pos < _piList.size())
+         _gates[_piList[pos]]->_name = line.substr(sp+1);
+      else if (line[0] == 'o' && pos < _poList.size())
+         _gates[_poList[pos]]->_name = line.substr(sp+1);
    }
 
    f.close();
-   return buildConnect();
+   return buildConnect(aigLine);
 }
 
-bool CirMgr::buildConnect() {
-   GateList::iterator i, k;
-   IdList::iterator j;
-   for (i = _ANDs->begin(); i != _ANDs->end(); i++){
-      for (j = i->second->getFanin()->begin(); j != i->second->getFanin()->end(); j++){
-         unsigned id = (*j)/2;
-         if (id == 0){
-            _CONST->setLineNo(i->second->getLineNo());
-            _CONST->gateRegist(i->first, i->second);
-            i->second->gateRegist(0, _CONST);
-            continue;
+// Create an UNDEF gate for every fanin that is not defined in the file, then
+// build the AIG gates in topological order through createAnd(). A gate that
+// folds or duplicates an existing one is not created; _repl maps its id to
+// the literal it became while the fanins are resolved.
+bool CirMgr::buildConnect(const IdList& aigLine) {
+   unsigned n = _gates.size();
+   for (unsigned id = 0; id < n; id++){
+      if (_types[id] != AIG_GATE && _types[id] != PO_GATE) continue;
+      for (unsigned k = 0; k < 2; k++){
+         if (k == 1 && _types[id] == PO_GATE) break;
+         unsigned in = (k == 0)? _fanin0[id]/2 : _fanin1[id]/2;
+         if (in > M){
+            unsigned lineNo = (_types[id] == PO_GATE)? _gates[id]->getLineNo() : aigLine[id];
+            cerr << "[ERROR] Line " << lineNo << ": Literal \"" << in*2
+                 << "\" exceeds maximum valid ID!!" << endl;
+            return false;
          }
-         k = _ANDs->find(id);
-         if (k != _ANDs->end()){
-            k->second->gateRegist(i->first, i->second);
-            i->second->gateRegist(id, k->second);
+         if (_types[in] == UNDEF_GATE && _gates[in] == NULL) addGate(UNDEF_GATE, in, 0);
+      }
+   }
+   _repl.resize(n);
+   for (unsigned id = 0; id < n; id++) _repl[id] = id*2;
+
+   vector<char> state(n, 0);      // 1: on the stack, 2: built
+   for (unsigned root = 0; root < n; root++){
+      if (_types[root] != AIG_GATE || state[root] != 0) continue;
+      _dfsStack.clear();
+      _dfsStack.push_back(root);
+      state[root] = 1;
+      while (!_dfsStack.empty()){
+         unsigned id = _dfsStack.back();
+         unsigned l = _fanin0[id]/2, r = _fanin1[id]/2;
+         if (_types[l] == AIG_GATE && state[l] != 2){
+            if (state[l] == 1){
+               cerr << "[ERROR] Line " << aigLine[id] << ": Combinational loop through literal \""
+                    << l*2 << "\"!!" << endl;
+               return false;
+            }
+            state[l] = 1;
+            _dfsStack.push_back(l);
             continue;
          }
-         k = _PIs->find(id);
-         if (k != _PIs->end()){
-            k->second->gateRegist(i->first, i->second);
-            i->second->gateRegist(id, k->second);
+         if (_types[r] == AIG_GATE && state[r] != 2){
+            if (state[r] == 1){
+               cerr << "[ERROR] Line " << aigLine[id] << ": Combinational loop through literal \""
+                    << r*2 << "\"!!" << endl;
+               return false;
+            }
+            state[r] = 1;
+            _dfsStack.push_back(r);
             continue;
          }
-         iGate* undef = new iGate(*j);
-         undef->_type = UNDEF_GATE;
-         undef->setLineNo(i->second->getLineNo());
-         _UNDEFs->insert(pair<unsigned, CirGate*>(id, undef));
-         i->second->gateRegist(id, undef);
-         undef->gateRegist(i->first, i->second);
-      }
-   }
-   i = _POs->begin();
-   while (i != _POs->end()){
-      unsigned id = i->first;
-      k = _ANDs->find(id);
-      if (k != _ANDs->end()){
-         unsigned newindex = _POs->rbegin()->second->getIndex()+1;
-         i->second->setIndex(newindex);
-         _POs->insert(pair<unsigned, CirGate*>(newindex, i->second));
-         k->second->gateRegist(id, i->second);
-         i->second->setFanin(id*2);
-         i->second->gateRegist(k->first, k->second);
-         _POs->erase(i++);
-         continue;
+         _dfsStack.pop_back();
+         state[id] = 2;
+         unsigned a = resolve(_fanin0[id]), b = resolve(_fanin1[id]);
+         _types[id] = UNDEF_GATE;
+         _fanin0[id] = _fanin1[id] = 0;
+         unsigned lit = createAnd(a, b, id);
+         if (lit == id*2) _gates[id]->setLineNo(aigLine[id]);
+         else _repl[id] = lit;
       }
-      k = _PIs->find(id);
-      if (k != _PIs->end()){
-         unsigned newindex = _POs->rbegin()->second->getIndex()+1;
-         i->second->setIndex(newindex);
-         _POs->insert(pair<unsigned, CirGate*>(newindex, i->second));
-         k->second->gateRegist(id, i->second);
-         i->second->setFanin(id*2);
-         i->second->gateRegist(k->first, k->second);
-         _POs->erase(i++);
-         continue;
-      }
-      i++;
    }
+   for (IdList::iterator it = _poList.begin(); it != _poList.end(); it++)
+      _fanin0[*it] = resolve(_fanin0[*it]);
+   for (unsigned id = 0; id < n; id++) _repl[id] = id*2;
+   _foValid = false;
+   _dfsValid = false;
    return true;
 }
 
 void CirMgr::resetlist() {
-   _ANDs->clear();
-   _PIs->clear();
-   _POs->clear();
-   _UNDEFs->clear();
-   _DFS->clear();
+   for (unsigned id = 0; id < _gates.size(); id++)
+      if (_gates[id] != NULL) delete _gates[id];
+   _gates.clear();
+   _types.clear();
+   _fanin0.clear();
+   _fanin1.clear();
+   _foStart.clear();
+   _foList.clear();
+   _foValid = false;
+   _repl.clear();
+   _piList.clear();
+   _poList.clear();
+   _dfsList.clear();
+   _dfsValid = false;
+   _strash.clear();
+   _strashValid = true;
+   _FECgroups.clear();
+   _fecOf.clear();
+   _fecInit = false;
+   _simNum = _roundNum = 0;
+   resetEngines();
 }
 
 CirGate* CirMgr::getGate(unsigned id) const {
-   GateList::iterator k = _ANDs->find(id);
-   if (k != _ANDs->end()) return k->second;
-   k = _PIs->find(id);
-   if (k != _PIs->end()) return k->second;
-   k = _POs->find(id);
-   if (k != _POs->end()) return k->second;
-   return NULL;
+   if (id >= _gates.size() || _gates[id] == NULL) return NULL;
+   if (_types[id] == UNDEF_GATE) return NULL;
+   return _gates[id];
+}
+
+/**********************************************************/
+/*   class CirMgr member functions for the node store     */
+/**********************************************************/
+void CirMgr::addGate(GateType t, unsigned id, unsigned lineNo) {
+   _gates[id] = new CirGate(t, id, lineNo);
+   _types[id] = t;
+}
+
+// Return the literal of "a AND b". Constant, identical and complementary
+// fanins are folded and a gate with the same fanins is reused; otherwise a
+// new AIG gate is created with id "id" (an empty slot) or the next free id.
+unsigned CirMgr::createAnd(unsigned a, unsigned b, unsigned id) {
+   if (a == 0 || b == 0 || a == (b^1)) return 0;
+   if (a == 1 || a == b) return b;
+   if (b == 1) return a;
+   buildStrash();
+   unsigned old;
+   if (_strash.check(a, b, old)) return old*2;
+   if (id == 0){
+      id = _gates.size();
+      _gates.push_back(NULL);
+      _types.push_back(UNDEF_GATE);
+      _fanin0.push_back(0);
+      _fanin1.push_back(0);
+      _repl.push_back(id*2);
+   }
+   assert(_gates[id] == NULL);
+   addGate(AIG_GATE, id, 0);
+   _fanin0[id] = a;
+   _fanin1[id] = b;
+   _strash.insert(a, b, id);
+   _foValid = false;
+   _dfsValid = false;
+   return id*2;
+}
+
+// Refill the unique table from the live AIG gates after merges or removals
+void CirMgr::buildStrash() {
+   if (_strashValid) return;
+   _strash.init(_gates.size());
+   for (unsigned id = 0; id < _gates.size(); id++){
+      if (_gates[id] == NULL || _types[id] != AIG_GATE || _repl[id] != id*2) continue;
+      unsigned a = resolve(_fanin0[id]), b = resolve(_fanin1[id]), old;
+      if (!_strash.check(a, b, old)) _strash.insert(a, b, id);
+   }
+   _strashValid = true;
+}
+
+// Fanouts are stored in compressed rows, rebuilt after structural changes
+void CirMgr::buildFanout() {
+   if (_foValid) return;
+   unsigned n = _gates.size();
+   _foStart.assign(n+1, 0);
+   for (unsigned id = 0; id < n; id++){
+      if (_gates[id] == NULL) continue;
+      if (_types[id] == PO_GATE) _foStart[_fanin0[id]/2+1]++;
+      else if (_types[id] == AIG_GATE){
+         _foStart[_fanin0[id]/2+1]++;
+         if (_fanin1[id]/2 != _fanin0[id]/2) _foStart[_fanin1[id]/2+1]++;
+      }
+   }
+   for (unsigned id = 0; id < n; id++) _foStart[id+1] += _foStart[id];
+   _foList.resize(_foStart[n]);
+   IdList fill(_foStart.begin(), _foStart.end()-1);
+   for (unsigned id = 0; id < n; id++){
+      if (_gates[id] == NULL) continue;
+      if (_types[id] == PO_GATE) _foList[fill[_fanin0[id]/2]++] = id;
+      else if (_types[id] == AIG_GATE){
+         _foList[fill[_fanin0[id]/2]++] = id;
+         if (_fanin1[id]/2 != _fanin0[id]/2) _foList[fill[_fanin1[id]/2]++] = id;
+      }
+   }
+   _foValid = true;
+}
+
+// Record that gate "id" is replaced by literal "lit"; the fanins of its
+// fanouts are redirected and the gate is removed by cleanup()
+void CirMgr::merge(unsigned id, unsigned lit) {
+   assert(id != 0 && resolve(lit)/2 != id);
+   _repl[id] = lit;
+   _dfsValid = false;
+   _strashValid = false;
+}
+
+// merge() for passes that keep using the unique table while they merge.
+// The table is not marked invalid, so it still holds the entries of merged
+// gates: a lookup may return a gate that is now replaced by another
+// literal. Callers look up resolved literals and resolve() what they get.
+void CirMgr::mergeKeepStrash(unsigned id, unsigned lit) {
+   bool valid = _strashValid;
+   merge(id, lit);
+   _strashValid = valid;
+}
+
+// Follow the merges recorded for lit, compressing the path on the way
+unsigned CirMgr::resolve(unsigned lit) {
+   unsigned rep = lit;
+   while (_repl[rep/2] != rep/2*2) rep = _repl[rep/2] ^ (rep & 1);
+   while (_repl[lit/2] != lit/2*2){
+      unsigned next = _repl[lit/2] ^ (lit & 1);
+      _repl[lit/2] = rep ^ (lit & 1);
+      lit = next;
+   }
+   return rep;
+}
+
+// Same as resolve() without changing _repl, so concurrent readers are safe
+unsigned CirMgr::follow(unsigned lit) const {
+   while (_repl[lit/2] != lit/2*2) lit = _repl[lit/2] ^ (lit & 1);
+   return lit;
+}
+
+void CirMgr::cleanup() {
+   for (unsigned id = 0; id < _gates.size(); id++){
+      if (_gates[id] == NULL) continue;
+      if (_types[id] == AIG_GATE || _types[id] == PO_GATE) _fanin0[id] = resolve(_fanin0[id]);
+      if (_types[id] == AIG_GATE) _fanin1[id] = resolve(_fanin1[id]);
+   }
+   for (unsigned id = 0; id < _gates.size(); id++)
+      if (_gates[id] != NULL && _repl[id] != id*2) removeGate(id);
+   _foValid = false;
+   _dfsValid = false;
+   purgeFEC();
+}
+
+// The gate must no longer be reachable from the POs (unused or merged),
+// so the DFS order is left untouched
+void CirMgr::removeGate(unsigned id) {
+   forgetVar(id);
+   delete _gates[id];
+   _gates[id] = NULL;
+   _types[id] = UNDEF_GATE;
+   _fanin0[id] = _fanin1[id] = 0;
+   _repl[id] = id*2;
+   _foValid = false;
+   _strashValid = false;
 }
 
 /**********************************************************/
@@ -296,9 +461,11 @@ Circuit Statistics
   Total      162
 *********************/
 void CirMgr::printSummary() const {
-   size_t num_pi = _PIs->size();
-   size_t num_po = _POs->size();
-   size_t num_aig = _ANDs->size();
+   size_t num_pi = _piList.size();
+   size_t num_po = _poList.size();
+   size_t num_aig = 0;
+   for (unsigned id = 0; id < _types.size(); id++)
+      if (_types[id] == AIG_GATE) num_aig++;
    cout << "Circuit Statistics" << endl
         << "==================" << endl
         << "  PI" << setw(12) << num_pi << endl
@@ -310,72 +477,73 @@ void CirMgr::printSummary() const {
 
 void CirMgr::printNetlist(){
    lineNo = 0;
-   resetMark(false);
-   GateList::iterator it = _POs->begin();
-   for (; it != _POs->end(); it++)
-      DFSprint(it->second);
+   buildDFS();
+   for (IdList::iterator it = _dfsList.begin(); it != _dfsList.end(); it++)
+      printGate(*it);
 }
 
 void CirMgr::printPIs() const {
    cout << "PIs of the circuit:";
-   for (GateList::iterator it = _PIs->begin(); it != _PIs->end(); it++)
-      cout << " " << it->first;
+   for (IdList::const_iterator it = _piList.begin(); it != _piList.end(); it++)
+      cout << " " << *it;
    cout << endl;
 }
 
 void CirMgr::printPOs() const {
    cout << "POs of the circuit:";
-   for (GateList::iterator it = _POs->begin(); it != _POs->end(); it++)
-      cout << " " << it->first;
+   for (IdList::const_iterator it = _poList.begin(); it != _poList.end(); it++)
+      cout << " " << *it;
    cout << endl;
 }
 
-void CirMgr::printFloatGates() const {
+void CirMgr::printFloatGates() {
    cout << "Gates with floating fanin(s):";
-   for (GateList::iterator it = _POs->begin(); it != _POs->end(); it++)
-      if (it->second->input() == NULL) cout << " " << it->first;
-   for (GateList::iterator it = _ANDs->begin(); it != _ANDs->end(); it++)
-      if (it->second->left_input() == NULL || it->second->right_input() == NULL)
-         cout << " " << it->first;
+   for (unsigned id = 0; id < _gates.size(); id++){
+      if (_types[id] == PO_GATE && _types[_fanin0[id]/2] == UNDEF_GATE)
+         cout << " " << id;
+      else if (_types[id] == AIG_GATE && (_types[_fanin0[id]/2] == UNDEF_GATE
+                                         || _types[_fanin1[id]/2] == UNDEF_GATE))
+         cout << " " << id;
+   }
    cout << endl << "Gates defined but not used :";
-   for (GateList::iterator it = _PIs->begin(); it != _PIs->end(); it++)
-      if (it->second->output()->size() == 0) cout << " " << it->first;
-   for (GateList::iterator it = _ANDs->begin(); it != _ANDs->end(); it++)
-      if (it->second->output()->size() == 0) cout << " " << it->first;
+   for (unsigned id = 0; id < _gates.size(); id++)
+      if ((_types[id] == PI_GATE || _types[id] == AIG_GATE) && getFanoutNum(id) == 0)
+         cout << " " << id;
    cout << endl;
 }
 
 void CirMgr::writeAag(ostream& outfile) {
-   size_t num_pi = _PIs->size();
-   size_t num_po = _POs->size();
-   size_t num_aig = _ANDs->size();
-   outfile << "aag " << num_pi+num_po+num_aig << " " << num_pi << " 0 " << num_po << " " << num_aig << endl;
-   GateList::iterator it;
-   for (it = _PIs->begin(); it != _PIs->end(); it++)
-      outfile << it->first*2 << endl;
-   bool empty = false;
-   if (_DFS->empty()){
-      resetMark(false);
-      empty = true;
+   buildDFS();
+   size_t num_aig = 0;
+   unsigned maxVar = M;     // gates added by rewriting may have ids above M+O
+   for (IdList::iterator it = _dfsList.begin(); it != _dfsList.end(); it++)
+      if (_types[*it] == AIG_GATE){
+         num_aig++;
+         if (*it > maxVar) maxVar = *it;
+      }
+   outfile << "aag " << maxVar << " " << _piList.size() << " 0 " << _poList.size() << " " << num_aig << endl;
+   for (IdList::iterator it = _piList.begin(); it != _piList.end(); it++)
+      outfile << *it*2 << endl;
+   for (IdList::iterator it = _poList.begin(); it != _poList.end(); it++)
+      outfile << _fanin0[*it] << endl;
+   for (IdList::iterator it = _dfsList.begin(); it != _dfsList.end(); it++){
+      if (_types[*it] != AIG_GATE) continue;
+      outfile << *it*2 << " " << _fanin0[*it] << " " << _fanin1[*it] << endl;
    }
-   for (it = _POs->begin(); it != _POs->end(); it++)
-      if (empty) DFScheck(it->second);
-      outfile << it->first*2+it->second->inverted() << endl;
-   for (it = _ANDs->begin(); it != _ANDs->end(); it++)
-      if (!(it->second->_mark)) continue;
-      outfile << it->first*2
-              << it->second->getFanin()->front()
-              << it->second->getFanin()->back() << endl;
+   for (unsigned i = 0; i < _piList.size(); i++)
+      if (_gates[_piList[i]]->_name != "") outfile << "i" << i << " " << _gates[_piList[i]]->_name << endl;
+   for (unsigned i = 0; i < _poList.size(); i++)
+      if (_gates[_poList[i]]->_name != "") outfile << "o" << i << " " << _gates[_poList[i]]->_name << endl;
 }
 
 void CirMgr::printFECPairs() const {
    lineNo = 0;
    FEClist::const_iterator i;
-   GateVList::const_iterator j;
+   IdList::const_iterator j;
    for (i = _FECgroups.begin(); i != _FECgroups.end(); i++){
       cout << "[" << lineNo++ << "]";
-      for (j = i->second.begin(); j != i->second.end(); j++)
-         cout << " " << (*j)->getIndex();
+      for (j = i->begin(); j != i->end(); j++)
+         cout << " " << (((*j ^ i->front()) & 1)?"!":"") << *j/2;
       cout << endl;
    }
 }
@@ -383,29 +551,77 @@ void CirMgr::printFECPairs() const {
 /**********************************************************/
 /*   class CirMgr member functions for DFS traversal		 */
 /**********************************************************/
-void CirMgr::resetMark(bool m){
-   GateList::iterator it;
-   _CONST->_mark = m;
-   for (it = _POs->begin(); it != _POs->end(); it++) it->second->_mark = m;
-   for (it = _PIs->begin(); it != _PIs->end(); it++) it->second->_mark = m;
-   for (it = _ANDs->begin(); it != _ANDs->end(); it++) it->second->_mark = m;
-   for (it = _UNDEFs->begin(); it != _UNDEFs->end(); it++) it->second->_mark = m;
+// Only when the traversal id wraps around do the gates need to be cleared
+void CirMgr::newTraversal(){
+   if (++CirGate::_globalRef == 0){
+      for (unsigned id = 0; id < _gates.size(); id++)
+         if (_gates[id] != NULL) _gates[id]->_ref = 0;
+      CirGate::_globalRef = 1;
+   }
 }
 
-void CirMgr::DFScheck(CirGate* g) {
-   g->_mark = true;
-   if (g->_type == PO_GATE){
-      if (!(g->input()->_mark)) DFScheck(g->input());
+// Iterative post-order DFS over the fanins of "root"; every gate not yet
+// marked in the current traversal is appended to "order" after its fanins.
+// _dfsStack is kept as a member so deep circuits need no recursion and no
+// reallocation between calls.
+void CirMgr::DFSorder(unsigned root, IdList& order) {
+   if (_gates[root]->isMarked()) return;
+   _gates[root]->setMark();
+   _dfsStack.clear();
+   _dfsStack.push_back(root);
+   while (!_dfsStack.empty()){
+      unsigned id = _dfsStack.back();
+      if (_types[id] == PO_GATE || _types[id] == AIG_GATE){
+         CirGate* in = _gates[_fanin0[id]/2];
+         if (!in->isMarked()){
+            in->setMark();
+            _dfsStack.push_back(_fanin0[id]/2);
+            continue;
+         }
+      }
+      if (_types[id] == AIG_GATE){
+         CirGate* in = _gates[_fanin1[id]/2];
+         if (!in->isMarked()){
+            in->setMark();
+            _dfsStack.push_back(_fanin1[id]/2);
+            continue;
+         }
+      }
+      _dfsStack.pop_back();
+      order.push_back(id);
    }
-   if (g->_type == AIG_GATE){
-      if (!(g->left_input()->_mark)) DFScheck(g->left_input());
-      if (!(g->right_input()->_mark)) DFScheck(g->right_input());
+}
+
+// The topological order is only recomputed after merges or cleanup();
+// simulation, strash, CNF generation and writing all iterate _dfsList
+void CirMgr::buildDFS() {
+   if (_dfsValid) return;
+   newTraversal();
+   _dfsList.clear();
+   for (IdList::iterator it = _poList.begin(); it != _poList.end(); it++)
+      DFSorder(*it, _dfsList);
+   _dfsValid = true;
+}
+
+// Logic level of every gate: the constant, PIs and UNDEF gates are at level
+// 0, an AIG gate is one above its deepest fanin and a PO is at the level of
+// its fanin. Gates outside the DFS order are left at 0.
+void CirMgr::buildLevel(IdList& level) {
+   buildDFS();
+   level.assign(_gates.size(), 0);
+   for (IdList::iterator it = _dfsList.begin(); it != _dfsList.end(); it++){
+      unsigned id = *it;
+      if (_types[id] == AIG_GATE){
+         unsigned l0 = level[_fanin0[id]/2], l1 = level[_fanin1[id]/2];
+         level[id] = ((l0 > l1)? l0 : l1) + 1;
+      }
+      else if (_types[id] == PO_GATE)
+         level[id] = level[_fanin0[id]/2];
    }
-   _DFS->push_back(g);
 }
 
-void CirMgr::DFSprint(CirGate* g) {
-   g->_mark = true;
+void CirMgr::printGate(unsigned id) {
+   CirGate* g = _gates[id];
    unsigned lid, rid;
    string n, inv, lt, linv, rt, rinv;
    CirGate *left_gate, *right_gate;
@@ -418,7 +634,6 @@ void CirMgr::DFSprint(CirGate* g) {
          cout << "[" << lineNo++ << "] PI " << g->getIndex() << " " << n << endl;
          break;
       case PO_GATE:
-         if (!(g->input()->_mark)) DFSprint(g->input());
          n = (g->_name.compare("") == 0)?"":("("+g->_name+")");
          inv = (g->inverted())?"!":"";
          cout << "[" << lineNo++ << "] PO " << g->getIndex() << " " << inv << g->input()->getIndex() << " " << n << endl;
@@ -426,8 +641,6 @@ void CirMgr::DFSprint(CirGate* g) {
       case AIG_GATE:
          left_gate = g->left_input();
          right_gate = g->right_input();
-         if (!(left_gate->_mark)) DFSprint(left_gate);
-         if (!(right_gate->_mark)) DFSprint(right_gate);
          if (left_gate->_type == CONST_GATE){
             lid = left_gate->getIndex();
             lt = "";
@@ -454,4 +667,3 @@ void CirMgr::DFSprint(CirGate* g) {
       default: cout << "[" << lineNo++ << "] UNDEF " << g->getIndex() << endl;
    }
 }
-
@@ -18,75 +18,180 @@ using namespace std;
 
 #include "cirDef.h"
 #include "cirGate.h"
+#include "cirStrash.h"
+#include "cirCut.h"
 
 extern CirMgr *cirMgr;
 
+struct FraigJob;
+struct ProofEngine;
+struct RewriteJob;
+struct RwrGraph;
+
 // TODO: Define your own data members and member functions
 class CirMgr {
 public:
    CirMgr() {
-      _PIs = new GateList;
-      _POs = new GateList;
-      _ANDs = new GateList;
-      _UNDEFs = new GateList;
-      _DFS = new GateVList;
-      _CONST = new conGate(0);
+      _simLog = NULL;
+      _simNum = 0;
+      _roundNum = 0;
+      _simLimit = 8;
+      _confLimit = _propLimit = 0;
+      _timeLimit = 0;
+      _deadline = 0;
+      _fecInit = false;
+      _fecPhase = false;
+      _foValid = false;
+      _dfsValid = false;
+      _strashValid = true;
+      M = I = L = O = A = 0;
    }
    ~CirMgr() { resetlist(); }
 
-   conGate* _CONST;
    FEClist _FECgroups;
+   const IdList* getFEC(unsigned id) const {
+      return (id < _fecOf.size() && _fecOf[id] != NO_FEC)? &_FECgroups[_fecOf[id]] : 0;
+   }
 
    // Access functions
    // return '0' if "gid" corresponds to an undefined gate.
    CirGate* getGate(unsigned) const;
 
+   // Node store access; ids are never out of range here
+   CirGate* getNode(unsigned id) const { return _gates[id]; }
+   GateType getType(unsigned id) const { return _types[id]; }
+   unsigned getFanin0(unsigned id) const { return _fanin0[id]; }
+   unsigned getFanin1(unsigned id) const { return _fanin1[id]; }
+   unsigned getFanoutNum(unsigned id) { buildFanout(); return _foStart[id+1]-_foStart[id]; }
+   unsigned getFanout(unsigned id, unsigned i) { buildFanout(); return _foList[_foStart[id]+i]; }
+
    // Member functions about circuit construction
    bool readCircuit(const string&);
+   unsigned createAnd(unsigned, unsigned, unsigned id = 0);
 
    // Member functions about circuit optimization
    void sweep();
    void optimize();
+   void rewrite();
+   void balance();
 
    // Member functions about simulation
    void randomSim();
    void fileSim(ifstream&);
    void setSimLog(ofstream *logFile) { _simLog = logFile; }
+   void setSimLimit(unsigned n) { _simLimit = n; }
+   unsigned getSimNum() const { return _simNum; }
+   unsigned getRoundNum() const { return _roundNum; }
+   SimWord getSimWord(unsigned id, unsigned w) const {
+      return (id*SIM_WORDS+w < _simValue.size())? _simValue[id*SIM_WORDS+w] : 0;
+   }
 
    // Member functions about fraig
    void strash();
    void printFEC() const;
-   void fraig();
+   void setFraigLimit(int conf, int prop, int sec) {
+      _confLimit = conf; _propLimit = prop; _timeLimit = sec;
+   }
+   void fraig(unsigned = 1);
+
+   // Member functions about cuts
+   void buildCuts(CutTable&, unsigned = CUT_SIZE, unsigned = 8);
 
    // Member functions about circuit reporting
    void printSummary() const;
    void printNetlist();
    void printPIs() const;
    void printPOs() const;
-   void printFloatGates() const;
+   void printFloatGates();
    void printFECPairs() const;
    void writeAag(ostream&);
-   void resetMark(bool);
+   void newTraversal();
 
 private:
    ofstream           *_simLog;
+   unsigned           _simNum;    // patterns applied since the FEC classes were set up
+   unsigned           _roundNum;  // patterns in the last round
+   unsigned           _simLimit;  // random rounds without a split before stopping
+   int                _confLimit; // conflicts of one SAT call in fraig, 0 for no limit
+   int                _propLimit; // propagations of one SAT call in fraig, 0 for no limit
+   int                _timeLimit; // wall-clock seconds of one fraig, 0 for no limit
+   double             _deadline;  // wall-clock end of the running fraig, 0 for none
+   bool               _fecInit;   // false until the first round on this netlist
+   bool               _fecPhase;  // false until the first round fixed the member phases
    unsigned M, I, L, O, A;
-   GateList* _PIs;
-   GateList* _POs;
-   GateList* _ANDs;
-   GateList* _UNDEFs;
-   GateVList* _DFS;
+
+   // Node store: struct of arrays indexed by gate id. Id 0 is CONST,
+   // PIs/AIGs/UNDEFs use their variable ids and POs are M+1 ... M+O.
+   GateVList          _gates;     // gate objects, NULL for unused ids
+   vector<GateType>   _types;
+   IdList             _fanin0;    // fanin literals (id*2 + inverted)
+   IdList             _fanin1;
+   IdList             _foStart;   // fanouts of id: _foList[_foStart[id] ... _foStart[id+1])
+   IdList             _foList;
+   bool               _foValid;
+   IdList             _repl;      // literal a gate is merged into, id*2 if not merged
+   IdList             _piList;    // PI ids in file order
+   IdList             _poList;    // PO ids in file order
+   IdList             _dfsList;   // ids in topological order from the POs
+   bool               _dfsValid;  // false after structural edits
+   IdList             _dfsStack;  // explicit stack of DFSorder()
+   StrashTable        _strash;    // unique table of the AIG gates
+   bool               _strashValid;  // false after merges and removals
+   vector<SimWord>    _simValue;  // [id*SIM_WORDS+w] words of the current round
+   IdList             _fecOf;     // [gate id] -> index in _FECgroups, or NO_FEC
+   vector<ProofEngine*> _engines; // SAT solvers of the fraig workers, kept across fraig runs
+   vector<unsigned char> _supNum; // [gate id] -> PIs in its cone, TT_VARS+1 if more (in fraig)
+   IdList             _supList;   // [id*TT_VARS+i] sorted PI ids of the cone of id
+   vector<SimWord>    _supTT;     // [id*TT_WORDS+w] truth table of id over its _supList
 
    void resetlist();
-   bool buildConnect();
-   void DFSopt(CirGate*);
-   void DFSsim(CirGate*);
-   void DFScheck(CirGate*);
-   void DFSprint(CirGate*);
+   bool buildConnect(const IdList&);
+   void addGate(GateType, unsigned, unsigned);
+   void buildStrash();
+   void buildFanout();
+   void merge(unsigned, unsigned);
+   void mergeKeepStrash(unsigned, unsigned);
+   unsigned resolve(unsigned);
+   unsigned follow(unsigned) const;
+   void cleanup();
+   void removeGate(unsigned);
+   void optGate(unsigned);
+   bool absorbed(unsigned);
+   void balanceGate(unsigned, IdList&, IdList&, IdList&);
+   void rewriteGate(unsigned, const CutTable&, RewriteJob&);
+   bool loadCut(const CirCut&, RewriteJob&);
+   unsigned mffcSize(unsigned, unsigned, RewriteJob&);
+   int rewriteCost(unsigned, const CirCut&, unsigned, RewriteJob&);
+   unsigned reviveSize(unsigned, unsigned, RewriteJob&);
+   unsigned buildRewrite(const CirCut&, RewriteJob&);
+   unsigned outLit(const RwrGraph&, const RewriteJob&) const;
+   void replaceGate(unsigned, unsigned, RewriteJob&);
+   void simulate(unsigned);
+   void DFSorder(unsigned, IdList&);
+   void buildDFS();
+   void buildLevel(IdList&);
+   void printGate(unsigned);
    void initsim();
-   void collectFEC();
-   void DFSinitSAT(CirGate*, SatSolver&, SatTable&);
-   bool solveSAT(Var&, Var&, SatSolver&);
+   void resimulate(const vector<SimWord>&, unsigned);
+   void initFEC();
+   bool refineFEC();
+   void levelFEC(const IdList&);
+   void purgeFEC();
+   void dropFEC(const vector<bool>&);
+   void indexFEC();
+   ProofEngine* getEngine(unsigned);
+   void buildSupport();
+   int truthCheck(unsigned, unsigned, ProofEngine&) const;
+   int cexValue(const ProofEngine&, unsigned) const;
+   void resetEngines();
+   void forgetVar(unsigned);
+   void encodeCone(unsigned, SatSolver&, SatTable&, IdList&) const;
+   int solveSAT(Var&, Var&, bool, SatSolver&) const;
+   bool timeUp() const;
+   void fraigSerial(const IdList&, unsigned&, unsigned&, unsigned&, unsigned&);
+   void fraigParallel(unsigned, const IdList&, unsigned&, unsigned&, unsigned&, unsigned&);
+   void provePairs(FraigJob&) const;
+   static void* fraigThread(void*);
 };
 
 #endif // CIR_MGR_H
@@ -7,6 +7,7 @@
 ****************************************************************************/
 
 #include <cassert>
+#include <algorithm>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "util.h"
@@ -16,6 +17,14 @@ using namespace std;
 /*******************************/
 /*   Global variable and enum  */
 /*******************************/
+// Orders literals by the level of their gates, deepest first
+struct DeeperLit
+{
+	DeeperLit(const IdList& l) : level(l) {}
+	bool operator () (unsigned a, unsigned b) const { return level[a/2] > level[b/2]; }
+
+	const IdList&       level;
+};
 
 /**************************************/
 /*   Static varaibles and functions   */
@@ -28,105 +37,150 @@ using namespace std;
 void
 CirMgr::sweep()
 {
-	GateList::iterator i, j;
 	clock_t c;
 	c = clock();
-	resetMark(false);
-	_DFS->clear();
-	for (i = _POs->begin(); i != _POs->end(); i++)
-		DFScheck(i->second);
-	for (i = _ANDs->begin(); i != _ANDs->end(); i++){
-		if (!i->second->_mark){
-			cout << "Clearing #" << i->first << endl;
-			_ANDs->erase(i);
-			i->second->left_input()->unregist(i->first);
-			i->second->right_input()->unregist(i->first);
-			for (j = i->second->output()->begin(); j != i->second->output()->end(); j++)
-				j->second->unregist(i->first);
+	buildDFS();
+	newTraversal();
+	for (IdList::iterator i = _dfsList.begin(); i != _dfsList.end(); i++)
+		_gates[*i]->setMark();
+	for (unsigned id = 0; id < _gates.size(); id++){
+		if (_gates[id] == NULL || _gates[id]->isMarked()) continue;
+		if (_types[id] == AIG_GATE || _types[id] == UNDEF_GATE){
+			cout << "Clearing #" << id << endl;
+			removeGate(id);
 		}
 	}
-	_UNDEFs->clear();
+	purgeFEC();
 	cout << "Sweeping takes " << float(clock()-c)/CLOCKS_PER_SEC << " seconds.\n";
 }
 
-// Recursively simplifying from POs;
-// _dfsList needs to be reconstructed afterwards
+// Simplifying in topological order from the PIs
 void
 CirMgr::optimize()
 {
-	GateList::iterator it;
+	IdList::iterator it;
 	clock_t c;
 	c = clock();
-	resetMark(false);
-	for (it = _POs->begin(); it != _POs->end(); it++)
-		DFSopt(it->second);
+	buildDFS();
+	for (it = _dfsList.begin(); it != _dfsList.end(); it++)
+		optGate(*it);
+	cleanup();
 	cout << "Optimization takes " << float(clock()-c)/CLOCKS_PER_SEC << " seconds.\n";
-	resetMark(false);
-	for (it = _POs->begin(); it != _POs->end(); it++)
-		DFScheck(it->second);
+}
+
+// Balancing in topological order. The supergate of a gate is the
+// multi-input AND under it: a fanin is expanded while it is an
+// uncomplemented AIG gate with no other fanout. The leaves of every
+// supergate are paired two at a time, the two shallowest first, so the
+// new tree is as shallow as their arrival levels allow. The expanded gates
+// that are not shared by the new trees become unused and are removed.
+void
+CirMgr::balance()
+{
+	clock_t c;
+	c = clock();
+	IdList level, leaves, stack;
+	unsigned before = 0, after = 0;
+	buildLevel(level);
+	buildFanout();
+	for (IdList::iterator it = _poList.begin(); it != _poList.end(); it++)
+		if (level[*it] > before) before = level[*it];
+	IdList order(_dfsList);
+	buildStrash();
+	for (IdList::iterator it = order.begin(); it != order.end(); it++)
+		if (_types[*it] == AIG_GATE && !absorbed(*it)) balanceGate(*it, level, leaves, stack);
+	cleanup();
+	buildDFS();
+	newTraversal();
+	for (IdList::iterator it = _dfsList.begin(); it != _dfsList.end(); it++)
+		_gates[*it]->setMark();
+	for (IdList::iterator it = order.begin(); it != order.end(); it++)
+		if (_gates[*it] != NULL && _types[*it] == AIG_GATE && !_gates[*it]->isMarked()) removeGate(*it);
+	buildLevel(level);
+	for (IdList::iterator it = _poList.begin(); it != _poList.end(); it++)
+		if (level[*it] > after) after = level[*it];
+	cout << "Depth " << before << " -> " << after << ".\n";
+	cout << "Balancing takes " << float(clock()-c)/CLOCKS_PER_SEC << " seconds.\n";
 }
 
 /***************************************************/
 /*   Private member functions about optimization   */
 /***************************************************/
+// True if the only fanout of the gate is an AIG gate that reads it
+// uncomplemented, so the gate belongs to the supergate of that fanout.
+// The fanouts are built once before the pass and go stale as soon as
+// createAnd() adds gates, so only the original ids may be asked: the DFS
+// order and the unresolved fanins of the original gates.
+bool
+CirMgr::absorbed(unsigned id)
+{
+	if (_foStart[id+1]-_foStart[id] != 1) return false;
+	unsigned fo = _foList[_foStart[id]];
+	return _types[fo] == AIG_GATE && (_fanin0[fo] == id*2 || _fanin1[fo] == id*2);
+}
+
+// Supergates below are already balanced, so the leaves are resolved to
+// their new trees. "level" is extended to the gates built here.
 void
-CirMgr::DFSopt(CirGate* g)
+CirMgr::balanceGate(unsigned id, IdList& level, IdList& leaves, IdList& stack)
 {
-	g->_mark = true;
-	if (g->_type == AIG_GATE){
-		if (!(g->left_input()->_mark)) DFSopt(g->left_input());
-		if (!(g->right_input()->_mark)) DFSopt(g->right_input());
-		CirGate* left = g->left_input();
-		bool left_inverted = g->left_inverted();
-		CirGate* right = g->right_input();
-		bool right_inverted = g->right_inverted();
-		CirGate* rep_gate;
-		bool rep_invt;
-		bool replace = true;
-		if (left->_type == CONST_GATE && right->_type == CONST_GATE){
-			rep_invt = (left_inverted && right_inverted);
-			rep_gate = _CONST;
-		}
-		else if (left->_type == CONST_GATE){
-			if (left_inverted){
-				rep_gate = _CONST;
-				rep_invt = false;
-			}
-			else {
-				rep_gate = right;
-				rep_invt = right_inverted;
-			}
+	leaves.clear();
+	stack.clear();
+	stack.push_back(_fanin0[id]);
+	stack.push_back(_fanin1[id]);
+	while (!stack.empty()){
+		unsigned lit = stack.back();
+		stack.pop_back();
+		if (!(lit & 1) && _types[lit/2] == AIG_GATE && absorbed(lit/2)){
+			stack.push_back(_fanin0[lit/2]);
+			stack.push_back(_fanin1[lit/2]);
 		}
-		else if (right->_type == CONST_GATE){
-			if (right_inverted){
-				rep_gate = _CONST;
-				rep_invt = false;
-			}
-			else {
-				rep_gate = left;
-				rep_invt = left_inverted;
-			}
+		else leaves.push_back(resolve(lit));
+	}
+	sort(leaves.begin(), leaves.end());
+	leaves.erase(unique(leaves.begin(), leaves.end()), leaves.end());
+	for (unsigned i = 0; i+1 < leaves.size(); i++)
+		if (leaves[i] == (leaves[i+1]^1)){
+			leaves.assign(1, 0);
+			break;
 		}
-		else if (left == right){
-			if (left_inverted == right_inverted){
-				rep_gate = left;
-				rep_invt = left_inverted;
-			}
-			else {
-				rep_gate = _CONST;
-				rep_invt = false;
-			}
+	sort(leaves.begin(), leaves.end(), DeeperLit(level));
+	while (leaves.size() > 1){
+		unsigned a = leaves.back();
+		leaves.pop_back();
+		unsigned b = leaves.back();
+		leaves.pop_back();
+		unsigned lit = resolve(createAnd(a, b));
+		if (lit/2 >= level.size()) level.resize(lit/2+1, 0);
+		if (lit/2 != a/2 && lit/2 != b/2 && lit > 1){
+			unsigned l0 = level[a/2], l1 = level[b/2];
+			level[lit/2] = ((l0 > l1)? l0 : l1) + 1;
 		}
+		leaves.insert(upper_bound(leaves.begin(), leaves.end(), lit, DeeperLit(level)), lit);
+	}
+	if (leaves[0] != id*2) mergeKeepStrash(id, leaves[0]);
+}
+
+// Fanins are visited first, so their replacements are already known
+void
+CirMgr::optGate(unsigned id)
+{
+	if (_types[id] == AIG_GATE){
+		unsigned left = _fanin0[id] = resolve(_fanin0[id]);
+		unsigned right = _fanin1[id] = resolve(_fanin1[id]);
+		unsigned rep;
+		bool replace = true;
+		if (left == 0 || right == 0) rep = 0;          // const 0 fanin
+		else if (left == 1) rep = right;               // const 1 fanin
+		else if (right == 1) rep = left;
+		else if (left == right) rep = left;            // identical fanins
+		else if (left == (right^1)) rep = 0;           // complementary fanins
 		else replace = false;
 		if (replace){
-			cout << "Replacing " << g->getIndex() << " with " << ((rep_invt)?"!":"") << rep_gate->getIndex() << endl;
-			GateList::iterator it;
-			for (it = g->output()->begin(); it != g->output()->end(); it++){
-				it->second->resetInput(g, rep_gate, rep_invt);
-				rep_gate->resetOutput(g, it->second);
-			}
+			cout << "Replacing " << id << " with " << ((rep%2)?"!":"") << rep/2 << endl;
+			merge(id, rep);
 		}
 	}
-	if (g->_type == PO_GATE)
-		if (!(g->input()->_mark)) DFSopt(g->input());
-}
\ No newline at end of file
+	if (_types[id] == PO_GATE)
+		_fanin0[id] = resolve(_fanin0[id]);
+}
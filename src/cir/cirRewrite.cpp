@@ -0,0 +1,604 @@
+/****************************************************************************
+  FileName     [ cirRewrite.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir AIG rewriting functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-2013 LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <algorithm>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+// Rewriting replaces the function of 4-input cuts
+#define RWR_VARS      4
+#define RWR_NODES     13
+
+// Smallest AIG found for an NPN class of 4-input functions. Literals 0/1
+// are the constants, 2..9 the inputs and 10, 12, ... the nodes in order;
+// "out" is the literal of the function.
+struct RwrGraph
+{
+	unsigned short      truth;     // the class representative
+	unsigned char       nodes;
+	unsigned char       out;
+	unsigned char       fanin[2*RWR_NODES];
+};
+
+// State of one rewriting pass
+struct RewriteJob
+{
+	RewriteJob() : phase(0), slot(0), rwrNum(0) {}
+
+	IdList              ref;       // [gate id] -> fanouts in the netlist, 0 if dead
+	IdList              stack;
+	IdList              cone;      // gates freed by replacing the current gate
+	IdList              dead;      // gates that lost their last fanout
+	IdList              revived;   // dead gates counted by rewriteCost() for the current graph
+	unsigned            leaves[RWR_VARS];  // resolved leaf literals of the current cut
+	unsigned            in[RWR_VARS];      // input literals of the library graph
+	unsigned            lit[RWR_NODES];    // node literals of the library graph
+	unsigned            phase;     // 1 if the graph gives the complement of the cut
+	unsigned            slot;      // free ids below it are taken
+	unsigned            rwrNum;
+};
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// One graph per class, in increasing order of the representatives, which are
+// the smallest truth tables of their classes (variable i is bit i of the
+// minterm index). The graphs come from SAT-based exact synthesis; all but
+// the graphs of 9 or more nodes are proven minimum.
+static const RwrGraph rwrLib[] = {
+	{ 0x0000,  0,  0, { 0 } },
+	{ 0x0001,  3, 14, { 7,9, 5,10, 3,12 } },
+	{ 0x0003,  2, 12, { 7,9, 5,10 } },
+	{ 0x0006,  5, 18, { 3,5, 2,4, 11,13, 7,14, 9,16 } },
+	{ 0x0007,  3, 14, { 2,4, 7,9, 11,12 } },
+	{ 0x000f,  1, 10, { 7,9 } },
+	{ 0x0016,  7, 22, { 5,7, 4,6, 3,10, 3,13, 11,17, 9,19, 15,20 } },
+	{ 0x0017,  5, 18, { 4,6, 5,7, 2,13, 11,15, 9,16 } },
+	{ 0x0018,  6, 20, { 2,5, 3,7, 4,6, 9,11, 13,15, 16,18 } },
+	{ 0x0019,  5, 18, { 2,5, 2,7, 4,13, 11,15, 9,16 } },
+	{ 0x001b,  4, 16, { 3,4, 2,6, 9,11, 13,14 } },
+	{ 0x001e,  5, 18, { 3,5, 6,11, 7,10, 9,15, 13,16 } },
+	{ 0x001f,  3, 14, { 3,5, 6,11, 9,13 } },
+	{ 0x003c,  4, 16, { 4,6, 5,7, 9,11, 13,14 } },
+	{ 0x003d,  5, 18, { 2,7, 4,6, 5,10, 9,15, 13,16 } },
+	{ 0x003f,  2, 12, { 4,6, 9,11 } },
+	{ 0x0069,  7, 22, { 3,5, 2,4, 11,13, 6,15, 7,14, 9,17, 19,20 } },
+	{ 0x006b,  7, 22, { 3,6, 2,7, 4,13, 10,14, 11,15, 17,19, 9,21 } },
+	{ 0x006f,  5, 18, { 2,4, 3,5, 11,13, 6,15, 9,17 } },
+	{ 0x007e,  6, 20, { 2,5, 2,6, 5,7, 13,15, 11,17, 9,19 } },
+	{ 0x007f,  3, 14, { 2,6, 4,10, 9,13 } },
+	{ 0x00ff,  0,  9, { 0 } },
+	{ 0x0116,  9, 26, { 4,6, 5,7, 9,12, 8,13, 3,17, 14,18, 15,19, 11,21, 23,24 } },
+	{ 0x0117,  7, 23, { 4,6, 5,7, 3,11, 13,15, 12,14, 9,17, 19,21 } },
+	{ 0x0118,  8, 24, { 3,4, 6,8, 7,9, 3,15, 4,14, 17,19, 11,21, 13,22 } },
+	{ 0x0119,  7, 23, { 4,7, 6,8, 3,13, 5,14, 9,15, 10,18, 17,21 } },
+	{ 0x011a,  7, 23, { 7,9, 6,8, 2,10, 5,11, 3,13, 16,18, 15,21 } },
+	{ 0x011b,  6, 21, { 6,8, 3,11, 5,12, 7,13, 9,16, 15,19 } },
+	{ 0x011e,  7, 23, { 3,5, 9,10, 8,11, 6,12, 7,13, 15,18, 17,21 } },
+	{ 0x011f,  5, 18, { 3,5, 6,11, 7,10, 8,15, 13,17 } },
+	{ 0x012c,  8, 25, { 3,6, 2,8, 7,9, 4,14, 5,15, 11,18, 13,20, 17,23 } },
+	{ 0x012d,  7, 22, { 2,5, 5,11, 6,10, 7,11, 8,13, 15,17, 19,21 } },
+	{ 0x012f,  5, 18, { 3,5, 2,5, 8,11, 6,13, 15,17 } },
+	{ 0x013c,  7, 22, { 3,7, 7,9, 8,11, 4,13, 5,12, 17,19, 15,20 } },
+	{ 0x013d,  6, 21, { 5,7, 4,6, 3,10, 9,11, 13,16, 15,19 } },
+	{ 0x013e,  7, 22, { 5,7, 4,6, 3,10, 9,14, 8,15, 17,19, 13,20 } },
+	{ 0x013f,  5, 19, { 3,5, 5,9, 8,11, 7,15, 13,17 } },
+	{ 0x0168, 10, 28, { 5,7, 4,6, 2,10, 8,11, 3,13, 2,12, 9,18, 17,21, 23,24, 15,26 } },
+	{ 0x0169,  8, 24, { 3,7, 4,9, 6,9, 2,14, 11,17, 4,19, 13,18, 21,23 } },
+	{ 0x016a,  8, 24, { 4,6, 5,7, 9,11, 8,13, 3,14, 2,15, 17,19, 21,22 } },
+	{ 0x016b,  8, 24, { 3,7, 4,6, 5,10, 2,12, 3,13, 9,19, 15,21, 17,23 } },
+	{ 0x016e,  8, 24, { 3,5, 2,4, 5,9, 8,11, 11,13, 7,15, 19,21, 17,23 } },
+	{ 0x016f,  6, 20, { 2,4, 3,5, 8,13, 11,13, 6,17, 15,19 } },
+	{ 0x017e,  8, 24, { 2,6, 3,7, 4,10, 5,12, 8,17, 15,17, 9,21, 19,23 } },
+	{ 0x017f,  6, 21, { 4,6, 5,7, 2,10, 3,12, 9,15, 17,19 } },
+	{ 0x0180,  7, 22, { 3,4, 2,7, 5,9, 6,8, 11,17, 15,18, 13,20 } },
+	{ 0x0181,  6, 20, { 2,6, 3,7, 9,10, 5,13, 4,15, 17,19 } },
+	{ 0x0182,  8, 24, { 3,9, 2,8, 7,11, 5,14, 4,15, 2,18, 17,21, 13,23 } },
+	{ 0x0183,  6, 20, { 2,4, 4,7, 2,8, 6,11, 13,15, 17,18 } },
+	{ 0x0186,  9, 26, { 5,7, 4,7, 4,9, 9,13, 11,15, 2,17, 3,16, 19,23, 21,24 } },
+	{ 0x0187,  7, 22, { 3,5, 2,4, 8,11, 7,13, 6,12, 17,19, 15,21 } },
+	{ 0x0189,  5, 18, { 2,5, 5,7, 2,9, 13,15, 11,17 } },
+	{ 0x018b,  5, 18, { 3,5, 5,6, 2,9, 11,15, 13,17 } },
+	{ 0x018f,  5, 18, { 3,5, 2,4, 8,11, 6,13, 15,17 } },
+	{ 0x0196,  9, 26, { 2,6, 3,7, 8,13, 11,13, 9,17, 5,19, 4,18, 21,23, 15,25 } },
+	{ 0x0197,  9, 27, { 2,4, 7,10, 6,11, 9,13, 15,16, 14,17, 3,21, 5,22, 19,25 } },
+	{ 0x0198,  8, 24, { 5,7, 2,9, 5,9, 3,10, 13,17, 14,19, 15,18, 21,23 } },
+	{ 0x0199,  6, 21, { 2,4, 6,8, 9,10, 5,13, 3,16, 15,19 } },
+	{ 0x019a,  8, 25, { 6,8, 5,11, 6,12, 9,15, 3,17, 2,16, 12,18, 21,23 } },
+	{ 0x019b,  7, 22, { 3,4, 5,6, 6,8, 9,13, 2,17, 15,19, 11,20 } },
+	{ 0x019e,  9, 26, { 2,4, 3,5, 6,13, 7,12, 8,17, 9,16, 15,21, 11,23, 19,25 } },
+	{ 0x019f,  7, 23, { 3,5, 2,4, 9,10, 8,11, 6,13, 17,19, 15,21 } },
+	{ 0x01a8,  6, 20, { 5,7, 2,8, 3,11, 9,10, 13,17, 15,18 } },
+	{ 0x01a9,  5, 18, { 5,7, 3,11, 9,11, 2,15, 13,17 } },
+	{ 0x01aa,  5, 19, { 5,7, 2,9, 8,10, 3,14, 13,17 } },
+	{ 0x01ab,  4, 16, { 5,7, 2,8, 3,11, 13,15 } },
+	{ 0x01ac,  7, 22, { 3,6, 5,7, 3,8, 9,13, 12,14, 17,19, 11,21 } },
+	{ 0x01ad,  6, 21, { 3,6, 5,7, 9,11, 3,12, 13,14, 17,19 } },
+	{ 0x01ae,  6, 20, { 3,5, 5,9, 8,11, 7,13, 3,17, 15,19 } },
+	{ 0x01af,  4, 16, { 3,5, 3,6, 8,11, 13,15 } },
+	{ 0x01bc,  8, 24, { 7,9, 3,11, 5,10, 4,12, 7,12, 15,17, 8,19, 20,23 } },
+	{ 0x01bd,  7, 23, { 5,7, 4,6, 3,10, 9,11, 3,12, 16,19, 15,21 } },
+	{ 0x01be,  8, 24, { 3,6, 9,11, 8,10, 5,15, 3,16, 12,18, 13,19, 21,23 } },
+	{ 0x01bf,  6, 21, { 6,8, 3,11, 5,12, 6,12, 9,17, 15,19 } },
+	{ 0x01e8,  8, 24, { 5,7, 4,6, 3,8, 2,11, 8,11, 13,17, 15,20, 19,23 } },
+	{ 0x01e9,  7, 22, { 5,7, 4,6, 2,10, 3,13, 9,17, 11,19, 15,21 } },
+	{ 0x01ea,  7, 23, { 3,5, 3,7, 7,8, 9,11, 10,14, 13,16, 19,21 } },
+	{ 0x01eb,  6, 21, { 3,5, 3,7, 9,11, 10,12, 13,14, 17,19 } },
+	{ 0x01ee,  5, 19, { 3,5, 9,11, 8,10, 7,14, 13,17 } },
+	{ 0x01ef,  4, 16, { 3,5, 6,10, 8,11, 13,15 } },
+	{ 0x01fe,  5, 18, { 5,7, 3,10, 9,12, 8,13, 15,17 } },
+	{ 0x033c,  6, 20, { 6,8, 7,9, 4,12, 5,13, 15,17, 11,19 } },
+	{ 0x033d,  7, 22, { 2,7, 5,9, 4,8, 7,13, 11,12, 17,19, 15,21 } },
+	{ 0x033f,  4, 16, { 4,6, 5,7, 8,13, 11,15 } },
+	{ 0x0356,  5, 19, { 5,7, 3,9, 11,12, 10,13, 15,17 } },
+	{ 0x0357,  3, 15, { 5,7, 3,9, 11,13 } },
+	{ 0x0358,  7, 23, { 5,7, 3,9, 7,9, 11,13, 14,16, 15,17, 19,21 } },
+	{ 0x0359,  7, 22, { 4,7, 3,9, 7,8, 13,15, 11,16, 10,17, 19,21 } },
+	{ 0x035a,  6, 20, { 3,9, 4,8, 7,11, 6,10, 15,17, 13,19 } },
+	{ 0x035b,  6, 20, { 3,9, 2,9, 6,11, 4,13, 7,16, 15,19 } },
+	{ 0x035e,  7, 22, { 5,7, 3,9, 3,11, 8,11, 7,13, 15,19, 17,21 } },
+	{ 0x035f,  4, 16, { 2,6, 5,7, 8,13, 11,15 } },
+	{ 0x0368,  8, 25, { 4,6, 5,7, 3,9, 9,11, 13,15, 17,19, 16,18, 21,23 } },
+	{ 0x0369,  8, 24, { 4,7, 2,9, 4,9, 6,15, 11,17, 13,19, 12,18, 21,23 } },
+	{ 0x036a,  8, 25, { 4,6, 5,8, 2,11, 3,10, 7,12, 15,17, 9,21, 19,23 } },
+	{ 0x036b,  7, 23, { 5,7, 4,6, 2,12, 3,13, 9,17, 15,18, 11,21 } },
+	{ 0x036c,  7, 23, { 2,6, 6,8, 9,11, 5,13, 15,16, 14,17, 19,21 } },
+	{ 0x036d,  8, 24, { 2,9, 7,11, 6,10, 5,13, 9,15, 15,16, 4,19, 21,23 } },
+	{ 0x036e,  8, 24, { 3,4, 5,9, 4,8, 3,12, 6,13, 15,17, 11,18, 20,23 } },
+	{ 0x036f,  7, 22, { 5,6, 6,9, 2,12, 9,15, 10,15, 4,17, 19,21 } },
+	{ 0x037c,  7, 23, { 5,7, 4,6, 2,12, 9,15, 11,16, 10,17, 19,21 } },
+	{ 0x037d,  7, 22, { 4,6, 5,7, 2,9, 8,13, 11,13, 14,19, 17,21 } },
+	{ 0x037e,  8, 24, { 5,7, 4,6, 3,9, 9,13, 10,14, 11,17, 15,20, 19,23 } },
+	{ 0x03c0,  5, 18, { 4,7, 5,9, 6,8, 11,15, 13,16 } },
+	{ 0x03c1,  6, 21, { 5,7, 2,9, 6,9, 10,13, 4,14, 17,19 } },
+	{ 0x03c3,  4, 16, { 4,7, 4,9, 6,13, 11,15 } },
+	{ 0x03c5,  6, 20, { 2,7, 5,7, 4,9, 9,10, 13,15, 17,19 } },
+	{ 0x03c6,  6, 20, { 2,7, 9,11, 4,13, 7,13, 5,17, 15,19 } },
+	{ 0x03c7,  5, 19, { 2,7, 5,7, 4,9, 11,14, 13,17 } },
+	{ 0x03cf,  3, 14, { 5,6, 4,8, 11,13 } },
+	{ 0x03d4,  7, 23, { 5,7, 4,6, 8,10, 9,11, 2,13, 16,19, 15,21 } },
+	{ 0x03d5,  6, 20, { 5,7, 4,6, 8,11, 2,13, 9,16, 15,19 } },
+	{ 0x03d6,  7, 23, { 4,6, 5,7, 2,11, 9,15, 13,16, 12,17, 19,21 } },
+	{ 0x03d7,  5, 19, { 4,6, 5,7, 2,11, 9,15, 13,17 } },
+	{ 0x03d8,  7, 23, { 2,4, 3,6, 5,7, 11,13, 8,14, 9,17, 19,21 } },
+	{ 0x03d9,  7, 22, { 5,7, 2,9, 5,12, 7,13, 9,17, 11,19, 15,21 } },
+	{ 0x03db,  6, 21, { 2,5, 3,7, 5,7, 9,11, 13,16, 15,19 } },
+	{ 0x03dc,  6, 21, { 3,6, 5,11, 7,12, 9,13, 8,14, 17,19 } },
+	{ 0x03dd,  5, 18, { 2,5, 5,7, 9,10, 8,13, 15,17 } },
+	{ 0x03de,  6, 20, { 2,5, 5,7, 9,11, 13,15, 12,14, 17,19 } },
+	{ 0x03fc,  4, 17, { 5,7, 9,11, 8,10, 13,15 } },
+	{ 0x0660,  7, 22, { 3,5, 2,4, 6,8, 7,9, 11,13, 17,18, 15,20 } },
+	{ 0x0661,  9, 26, { 3,5, 2,4, 6,8, 7,9, 13,15, 10,17, 11,16, 18,23, 21,24 } },
+	{ 0x0662,  7, 22, { 2,4, 7,9, 6,8, 4,13, 3,17, 15,19, 11,20 } },
+	{ 0x0663,  7, 22, { 7,9, 6,8, 3,11, 4,14, 5,15, 17,19, 13,21 } },
+	{ 0x0666,  5, 18, { 3,4, 2,5, 6,8, 11,13, 15,17 } },
+	{ 0x0667,  7, 22, { 2,4, 3,5, 6,12, 7,13, 9,15, 17,19, 11,21 } },
+	{ 0x0669,  9, 26, { 7,9, 6,8, 2,11, 3,10, 15,17, 4,19, 5,18, 13,21, 23,24 } },
+	{ 0x066b,  9, 26, { 7,9, 6,8, 4,11, 5,10, 3,14, 3,17, 15,21, 19,23, 13,25 } },
+	{ 0x066f,  7, 22, { 2,4, 3,5, 6,8, 7,9, 11,13, 17,19, 15,21 } },
+	{ 0x0672,  7, 22, { 2,4, 4,8, 6,8, 7,13, 11,15, 3,16, 18,21 } },
+	{ 0x0673,  7, 22, { 3,5, 7,9, 7,11, 3,13, 8,15, 4,17, 19,21 } },
+	{ 0x0676,  6, 20, { 2,4, 3,5, 6,9, 7,13, 15,17, 11,19 } },
+	{ 0x0678,  9, 26, { 3,5, 2,4, 9,13, 11,13, 7,14, 8,17, 7,21, 15,23, 19,25 } },
+	{ 0x0679,  9, 26, { 2,4, 3,5, 7,11, 6,10, 13,14, 9,18, 8,19, 17,23, 21,24 } },
+	{ 0x067a,  8, 24, { 4,8, 6,8, 7,11, 3,14, 4,15, 2,18, 17,21, 13,22 } },
+	{ 0x067b,  9, 26, { 3,5, 7,11, 9,12, 8,13, 3,15, 2,14, 4,21, 19,22, 17,25 } },
+	{ 0x067e,  8, 24, { 3,5, 6,8, 7,9, 7,10, 4,15, 13,17, 2,18, 20,23 } },
+	{ 0x0690,  8, 24, { 3,5, 2,4, 6,9, 11,13, 6,16, 8,16, 15,21, 19,23 } },
+	{ 0x0691,  9, 27, { 3,5, 2,4, 7,11, 8,13, 11,13, 14,16, 15,19, 9,22, 21,25 } },
+	{ 0x0693,  8, 25, { 2,7, 3,9, 6,8, 11,13, 4,15, 17,19, 16,18, 21,23 } },
+	{ 0x0696,  7, 23, { 2,5, 3,4, 11,13, 7,15, 6,14, 9,18, 17,21 } },
+	{ 0x0697,  8, 24, { 3,5, 2,4, 7,11, 7,12, 11,13, 9,19, 15,21, 17,23 } },
+	{ 0x069f,  6, 21, { 3,5, 2,4, 11,13, 7,14, 9,15, 17,19 } },
+	{ 0x06b0,  8, 24, { 3,4, 2,5, 7,9, 9,11, 11,13, 7,19, 17,21, 15,23 } },
+	{ 0x06b1,  9, 27, { 3,4, 2,7, 4,7, 9,11, 8,14, 17,19, 12,20, 13,21, 23,25 } },
+	{ 0x06b2,  8, 24, { 2,5, 3,4, 7,8, 7,11, 9,13, 13,16, 15,19, 21,23 } },
+	{ 0x06b3,  8, 25, { 3,4, 2,7, 4,7, 8,13, 11,17, 14,16, 15,18, 21,23 } },
+	{ 0x06b4,  8, 24, { 2,5, 3,4, 9,13, 11,13, 6,15, 15,17, 7,21, 19,23 } },
+	{ 0x06b5,  8, 25, { 3,4, 2,7, 4,7, 9,11, 15,17, 12,18, 13,19, 21,23 } },
+	{ 0x06b6,  7, 23, { 3,4, 2,5, 9,11, 11,13, 6,14, 7,17, 19,21 } },
+	{ 0x06b7,  8, 24, { 3,5, 2,6, 3,7, 7,11, 4,13, 8,17, 15,18, 21,23 } },
+	{ 0x06b9,  8, 25, { 2,4, 2,7, 7,8, 5,13, 11,17, 9,19, 14,18, 21,23 } },
+	{ 0x06bd,  8, 25, { 3,4, 2,5, 9,11, 11,13, 7,17, 14,19, 15,18, 21,23 } },
+	{ 0x06f0,  7, 23, { 2,5, 3,4, 6,9, 7,8, 11,13, 16,19, 15,21 } },
+	{ 0x06f1,  7, 23, { 3,5, 2,4, 7,11, 9,15, 13,14, 8,18, 17,21 } },
+	{ 0x06f2,  7, 23, { 3,4, 2,5, 6,9, 8,10, 13,17, 7,19, 15,21 } },
+	{ 0x06f6,  6, 20, { 3,5, 2,4, 6,8, 11,13, 7,17, 15,19 } },
+	{ 0x06f9,  7, 23, { 3,5, 2,4, 7,11, 13,14, 8,16, 9,17, 19,21 } },
+	{ 0x0776,  7, 22, { 3,5, 2,4, 6,9, 9,10, 7,17, 15,19, 13,21 } },
+	{ 0x0778,  7, 22, { 2,4, 7,11, 6,10, 9,15, 13,17, 12,16, 19,21 } },
+	{ 0x0779,  9, 26, { 6,8, 7,9, 3,13, 2,12, 5,16, 15,17, 11,19, 4,20, 22,25 } },
+	{ 0x077a,  7, 22, { 2,4, 6,8, 7,9, 11,13, 3,14, 15,17, 19,21 } },
+	{ 0x077e,  8, 24, { 2,4, 3,5, 7,9, 6,8, 11,15, 13,14, 19,21, 17,23 } },
+	{ 0x07b0,  7, 23, { 2,4, 7,8, 6,9, 4,11, 11,12, 14,17, 19,21 } },
+	{ 0x07b1,  8, 24, { 5,8, 4,9, 6,9, 2,11, 7,17, 12,17, 15,19, 21,23 } },
+	{ 0x07b4,  7, 23, { 3,4, 4,11, 9,11, 6,14, 7,15, 13,18, 17,21 } },
+	{ 0x07b5,  7, 23, { 3,4, 9,11, 5,13, 6,12, 2,15, 7,19, 17,21 } },
+	{ 0x07b6,  8, 25, { 3,4, 2,5, 9,11, 3,15, 6,14, 13,17, 7,21, 19,23 } },
+	{ 0x07bc,  7, 22, { 2,4, 4,11, 7,11, 9,13, 15,17, 14,16, 19,21 } },
+	{ 0x07e0,  7, 22, { 3,5, 2,4, 7,9, 9,11, 7,13, 17,19, 15,21 } },
+	{ 0x07e1,  7, 23, { 2,4, 3,5, 9,13, 7,15, 6,14, 11,16, 19,21 } },
+	{ 0x07e2,  7, 22, { 2,4, 4,6, 3,9, 6,8, 11,15, 13,19, 17,21 } },
+	{ 0x07e3,  7, 22, { 3,5, 9,11, 3,13, 6,13, 7,15, 4,18, 17,21 } },
+	{ 0x07e6,  7, 22, { 2,7, 3,9, 6,8, 4,10, 5,12, 17,19, 15,20 } },
+	{ 0x07e9,  7, 23, { 3,5, 2,4, 9,11, 7,13, 15,16, 14,17, 19,21 } },
+	{ 0x07f0,  5, 19, { 2,4, 6,9, 7,11, 8,14, 13,17 } },
+	{ 0x07f1,  7, 22, { 3,8, 2,9, 6,8, 4,11, 13,17, 7,19, 15,21 } },
+	{ 0x07f2,  6, 20, { 2,4, 3,9, 6,8, 11,13, 7,17, 15,19 } },
+	{ 0x07f8,  5, 18, { 2,4, 7,11, 8,13, 9,12, 15,17 } },
+	{ 0x0ff0,  3, 15, { 7,8, 6,9, 11,13 } },
+	{ 0x1668, 13, 35, { 5,7, 4,6, 2,13, 3,12, 11,14, 17,19, 3,10, 2,11, 23,25, 13,26, 9,21, 8,28, 31,33 } },
+	{ 0x1669, 11, 31, { 5,9, 4,8, 11,13, 3,15, 2,14, 17,19, 2,12, 6,23, 20,24, 21,25, 27,29 } },
+	{ 0x166a,  9, 27, { 4,6, 5,7, 8,13, 11,15, 8,10, 3,19, 17,20, 16,21, 23,25 } },
+	{ 0x166b, 12, 33, { 6,8, 7,9, 3,13, 10,15, 11,14, 17,19, 11,13, 2,23, 4,25, 21,26, 20,27, 29,31 } },
+	{ 0x166e,  9, 27, { 7,9, 6,8, 5,13, 4,12, 11,15, 3,17, 2,19, 15,20, 23,25 } },
+	{ 0x167e,  9, 26, { 2,6, 3,7, 9,11, 8,10, 4,12, 4,15, 13,21, 19,23, 17,25 } },
+	{ 0x1681, 11, 31, { 4,9, 5,8, 2,13, 3,12, 11,17, 15,18, 2,10, 17,23, 7,20, 6,25, 27,29 } },
+	{ 0x1683, 10, 29, { 3,8, 7,10, 6,11, 13,15, 2,9, 14,19, 4,21, 17,22, 16,23, 25,27 } },
+	{ 0x1686, 10, 29, { 5,6, 4,7, 8,10, 13,15, 4,9, 6,19, 13,21, 3,17, 2,22, 25,27 } },
+	{ 0x1687,  9, 27, { 2,4, 5,8, 4,8, 3,12, 11,17, 6,19, 7,18, 15,20, 23,25 } },
+	{ 0x1689,  9, 26, { 3,5, 2,4, 7,10, 6,11, 13,15, 9,18, 17,18, 8,23, 21,25 } },
+	{ 0x168b, 10, 28, { 2,9, 3,8, 4,11, 6,13, 7,12, 5,16, 14,19, 15,18, 21,23, 25,26 } },
+	{ 0x168e,  9, 27, { 5,6, 4,7, 8,10, 13,15, 4,8, 11,19, 3,17, 2,20, 23,25 } },
+	{ 0x1696,  8, 25, { 3,4, 6,8, 4,13, 2,15, 11,17, 6,18, 7,19, 21,23 } },
+	{ 0x1697,  9, 26, { 5,7, 4,6, 8,10, 9,12, 13,15, 11,17, 3,19, 2,20, 23,25 } },
+	{ 0x1698,  9, 27, { 2,4, 3,5, 9,11, 6,12, 11,13, 7,18, 8,21, 15,23, 17,25 } },
+	{ 0x1699,  8, 25, { 3,5, 2,4, 6,13, 11,13, 8,15, 17,19, 16,18, 21,23 } },
+	{ 0x169a,  8, 24, { 4,6, 5,7, 4,9, 13,15, 2,16, 11,16, 3,21, 19,23 } },
+	{ 0x169b, 10, 29, { 7,8, 4,11, 5,10, 13,15, 5,6, 4,8, 19,21, 3,16, 2,22, 25,27 } },
+	{ 0x169e,  8, 25, { 2,4, 3,5, 7,11, 9,10, 13,14, 12,15, 19,21, 17,22 } },
+	{ 0x16a9,  9, 26, { 5,7, 4,6, 3,8, 2,9, 13,14, 17,19, 10,21, 11,20, 23,25 } },
+	{ 0x16ac,  9, 27, { 3,6, 2,8, 11,13, 3,8, 6,17, 5,19, 15,20, 14,21, 23,25 } },
+	{ 0x16ad,  9, 27, { 2,9, 5,8, 3,12, 11,15, 2,4, 7,19, 16,20, 17,21, 23,25 } },
+	{ 0x16bc,  8, 25, { 3,6, 2,8, 11,13, 2,6, 5,17, 15,18, 14,19, 21,23 } },
+	{ 0x16e9,  9, 27, { 5,7, 9,11, 8,10, 13,15, 4,6, 3,19, 16,20, 17,21, 23,25 } },
+	{ 0x177e,  9, 26, { 3,7, 5,9, 4,8, 6,13, 10,13, 11,15, 2,16, 19,21, 23,25 } },
+	{ 0x178e,  8, 24, { 2,4, 3,5, 7,11, 9,10, 9,12, 13,17, 15,20, 19,23 } },
+	{ 0x1796,  9, 27, { 5,7, 4,6, 2,11, 11,13, 9,17, 2,18, 13,19, 15,22, 21,25 } },
+	{ 0x1798,  8, 25, { 2,4, 3,5, 7,11, 9,11, 8,15, 12,15, 17,19, 21,23 } },
+	{ 0x179a,  9, 26, { 5,6, 4,8, 7,8, 3,10, 2,11, 12,18, 15,19, 17,22, 21,25 } },
+	{ 0x17ac,  8, 25, { 2,6, 4,7, 11,13, 3,4, 8,17, 14,18, 15,19, 21,23 } },
+	{ 0x17e8,  7, 23, { 5,7, 4,6, 3,13, 11,15, 8,17, 9,16, 19,21 } },
+	{ 0x18e7,  8, 25, { 2,5, 3,7, 4,6, 11,13, 15,16, 9,19, 8,18, 21,23 } },
+	{ 0x19e1,  9, 27, { 6,9, 7,8, 2,12, 11,15, 2,13, 5,19, 16,20, 17,21, 23,25 } },
+	{ 0x19e3,  9, 27, { 2,8, 6,9, 3,12, 11,15, 2,6, 4,19, 17,20, 16,21, 23,25 } },
+	{ 0x19e6,  7, 22, { 2,5, 2,7, 4,13, 11,15, 8,17, 9,16, 19,21 } },
+	{ 0x1bd8,  9, 27, { 5,8, 6,9, 11,13, 4,9, 7,8, 17,19, 3,15, 2,21, 23,25 } },
+	{ 0x1be4,  6, 20, { 3,5, 2,7, 11,13, 8,14, 9,15, 17,19 } },
+	{ 0x1ee1,  7, 23, { 3,5, 7,9, 6,8, 13,15, 10,17, 11,16, 19,21 } },
+	{ 0x3cc3,  6, 21, { 6,8, 7,9, 11,13, 5,15, 4,14, 17,19 } },
+	{ 0x6996,  9, 27, { 6,8, 7,9, 11,13, 5,15, 4,14, 17,19, 3,20, 2,21, 23,25 } }
+};
+
+static const unsigned rwrClassNum = sizeof(rwrLib) / sizeof(RwrGraph);
+
+// [truth] -> class and the transform from its representative: bits 0-3
+// complement the inputs, bit 4 the output and the rest is the permutation
+static unsigned char npnClass[1 << 16];
+static unsigned short npnForm[1 << 16];
+static unsigned char npnPerm[24][RWR_VARS];
+
+// Function x -> o ^ f(y), y_i = x_perm[i] ^ neg_i
+static unsigned
+npnApply(unsigned f, unsigned p, unsigned neg, unsigned o)
+{
+	unsigned g = 0;
+	for (unsigned m = 0; m < (1u << RWR_VARS); m++){
+		unsigned y = 0;
+		for (unsigned i = 0; i < RWR_VARS; i++)
+			y |= (((m >> npnPerm[p][i]) ^ (neg >> i)) & 1) << i;
+		if (((f >> y) ^ o) & 1) g |= 1u << m;
+	}
+	return g;
+}
+
+// Truth tables are scanned upwards, so the first one of a class is its
+// representative and the whole orbit is labeled from it
+static void
+initNpn()
+{
+	static bool ready = false;
+	if (ready) return;
+	unsigned p[RWR_VARS] = { 0, 1, 2, 3 }, n = 0;
+	do {
+		for (unsigned i = 0; i < RWR_VARS; i++) npnPerm[n][i] = p[i];
+		n++;
+	} while (next_permutation(p, p+RWR_VARS));
+	vector<bool> done(1 << 16, false);
+	unsigned cls = 0;
+	for (unsigned f = 0; f < (1u << 16); f++){
+		if (done[f]) continue;
+		assert(cls < rwrClassNum && rwrLib[cls].truth == f);
+		for (unsigned q = 0; q < 24; q++)
+			for (unsigned neg = 0; neg < 16; neg++)
+				for (unsigned o = 0; o < 2; o++){
+					unsigned g = npnApply(f, q, neg, o);
+					if (done[g]) continue;
+					done[g] = true;
+					npnClass[g] = cls;
+					npnForm[g] = (q << 5) | (o << 4) | neg;
+				}
+		cls++;
+	}
+	assert(cls == rwrClassNum);
+	ready = true;
+}
+
+// Constant, identical and complementary fanins, as in CirMgr::createAnd()
+static inline bool
+foldAnd(unsigned a, unsigned b, unsigned& lit)
+{
+	if (a == 0 || b == 0 || a == (b^1)) lit = 0;
+	else if (a == 1 || a == b) lit = b;
+	else if (b == 1) lit = a;
+	else return false;
+	return true;
+}
+
+/***********************************************/
+/*   Public member functions about rewriting   */
+/***********************************************/
+// DAG-aware rewriting in topological order. Every 4-input cut of a gate is
+// matched to the library graph of its NPN class; the gates that would be
+// freed (the cone of the gate that only fans out inside the cut) are
+// weighed against the nodes of the graph that the unique table cannot
+// share, and the gate is replaced through the cut that saves the most.
+// A gate is first rehashed on its current fanins, so the gates left equal
+// by earlier replacements are merged as well.
+void
+CirMgr::rewrite()
+{
+	clock_t c;
+	c = clock();
+	initNpn();
+	RewriteJob j;
+	CutTable t;
+	buildCuts(t, RWR_VARS);
+	IdList order(_dfsList);
+	unsigned before = 0, after = 0;
+	j.ref.assign(_gates.size(), 0);
+	for (IdList::iterator it = order.begin(); it != order.end(); it++){
+		if (_types[*it] == AIG_GATE){
+			before++;
+			j.ref[resolve(_fanin0[*it])/2]++;
+			j.ref[resolve(_fanin1[*it])/2]++;
+		}
+		else if (_types[*it] == PO_GATE) j.ref[resolve(_fanin0[*it])/2]++;
+	}
+	j.slot = 1;
+	buildStrash();
+	for (IdList::iterator it = order.begin(); it != order.end(); it++)
+		if (_types[*it] == AIG_GATE && j.ref[*it] > 0) rewriteGate(*it, t, j);
+	for (IdList::iterator it = j.dead.begin(); it != j.dead.end(); it++)
+		if (_gates[*it] != NULL && _repl[*it] == *it*2 && j.ref[*it] == 0) removeGate(*it);
+	cleanup();
+	buildDFS();
+	for (IdList::iterator it = _dfsList.begin(); it != _dfsList.end(); it++)
+		if (_types[*it] == AIG_GATE) after++;
+	cout << j.rwrNum << " gates rewritten, " << before << " -> " << after << " AIG gates.\n";
+	cout << "Rewriting takes " << float(clock()-c)/CLOCKS_PER_SEC << " seconds.\n";
+}
+
+/************************************************/
+/*   Private member functions about rewriting   */
+/************************************************/
+void
+CirMgr::rewriteGate(unsigned id, const CutTable& t, RewriteJob& j)
+{
+	unsigned a = _fanin0[id] = resolve(_fanin0[id]);
+	unsigned b = _fanin1[id] = resolve(_fanin1[id]);
+	unsigned lit, old;
+	if (foldAnd(a, b, lit) || (_strash.check(a, b, old) && (lit = resolve(old*2))/2 != id)){
+		cout << "Rewriting " << id << " with " << ((lit%2)?"!":"") << lit/2 << endl;
+		replaceGate(id, lit, j);
+		j.rwrNum++;
+		return;
+	}
+	if (!_strash.check(a, b, old)) _strash.insert(a, b, id);
+
+	int best = 0;
+	unsigned bestCut = 0;
+	for (unsigned i = 0; i+1 < t.cutNum(id); i++){
+		const CirCut& cut = t.getCut(id, i);
+		if (!loadCut(cut, j)) continue;
+		unsigned saved = mffcSize(id, cut.nLeaves, j);
+		int gain = (int)saved - rewriteCost(id, cut, saved, j);
+		for (unsigned k = 0; k < j.cone.size(); k++){
+			unsigned g = j.cone[k];
+			j.ref[resolve(_fanin0[g])/2]++;
+			j.ref[resolve(_fanin1[g])/2]++;
+		}
+		if (gain > best){ best = gain; bestCut = i; }
+	}
+	if (best == 0) return;
+	const CirCut& cut = t.getCut(id, bestCut);
+	loadCut(cut, j);
+	lit = buildRewrite(cut, j);
+	cout << "Rewriting " << id << " with " << ((lit%2)?"!":"") << lit/2 << endl;
+	replaceGate(id, lit, j);
+	j.rwrNum++;
+}
+
+// Resolve the leaves of the cut; false if one of them is dead
+bool
+CirMgr::loadCut(const CirCut& cut, RewriteJob& j)
+{
+	for (unsigned i = 0; i < RWR_VARS; i++){
+		j.leaves[i] = (i < cut.nLeaves)? resolve(cut.leaves[i]*2) : 0;
+		unsigned g = j.leaves[i]/2;
+		if (_types[g] == AIG_GATE && j.ref[g] == 0) return false;
+	}
+	unsigned f = cut.truth & 0xffff, form = npnForm[f];
+	for (unsigned i = 0; i < RWR_VARS; i++)
+		j.in[i] = j.leaves[npnPerm[form >> 5][i]] ^ ((form >> i) & 1);
+	j.phase = (form >> 4) & 1;
+	return true;
+}
+
+// Gates freed if "id" lost its fanouts, stopping at the first "leaves"
+// leaves of the loaded cut; they are dereferenced and listed in j.cone
+unsigned
+CirMgr::mffcSize(unsigned id, unsigned leaves, RewriteJob& j)
+{
+	j.cone.clear();
+	j.stack.clear();
+	j.stack.push_back(id);
+	while (!j.stack.empty()){
+		unsigned g = j.stack.back();
+		j.stack.pop_back();
+		j.cone.push_back(g);
+		unsigned in[2] = { resolve(_fanin0[g])/2, resolve(_fanin1[g])/2 };
+		for (unsigned k = 0; k < 2; k++){
+			if (--j.ref[in[k]] > 0 || _types[in[k]] != AIG_GATE) continue;
+			bool leaf = false;
+			for (unsigned i = 0; i < leaves && !leaf; i++) leaf = (j.leaves[i]/2 == in[k]);
+			if (!leaf) j.stack.push_back(in[k]);
+		}
+	}
+	return j.cone.size();
+}
+
+// Nodes of the library graph that would be added, or "limit" once it is
+// clear the graph saves nothing. A node is shared through the unique table
+// if both its fanins exist. The table still holds merged gates, so a hit is
+// resolved, and a resolved gate that is freed or dead counts with the dead
+// part of its cone, which replaceGate() would revive with it.
+// A graph that goes through "id" itself is rejected.
+int
+CirMgr::rewriteCost(unsigned id, const CirCut& cut, unsigned limit, RewriteJob& j)
+{
+	const RwrGraph& g = rwrLib[npnClass[cut.truth & 0xffff]];
+	const unsigned none = ~0u;
+	unsigned added = 0, old;
+	j.revived.clear();
+	for (unsigned k = 0; k < g.nodes; k++){
+		unsigned lit[2];
+		for (unsigned m = 0; m < 2; m++){
+			unsigned l = g.fanin[2*k+m];
+			if (l < 2) lit[m] = l;
+			else if (l < 2+2*RWR_VARS) lit[m] = j.in[(l-2)/2] ^ (l & 1);
+			else lit[m] = (j.lit[(l-2)/2-RWR_VARS] == none)? none : j.lit[(l-2)/2-RWR_VARS] ^ (l & 1);
+		}
+		j.lit[k] = none;
+		if (lit[0] != none && lit[1] != none){
+			if (foldAnd(lit[0], lit[1], j.lit[k])) ;
+			else if (_strash.check(lit[0], lit[1], old)){
+				j.lit[k] = resolve(old*2);
+				added += reviveSize(j.lit[k]/2, limit-added, j);
+			}
+			else added++;
+		}
+		else added++;
+		if (added >= limit || (j.lit[k] != none && j.lit[k]/2 == id)) return limit;
+	}
+	unsigned out = outLit(g, j);
+	return (out != none && out/2 == id)? limit : added;
+}
+
+// Gates without fanouts that sharing gate "n" would bring back: "n" and its
+// cone down to the live gates and the leaves of the loaded cut, leaving out
+// those already in j.revived. Stops after "limit" gates.
+unsigned
+CirMgr::reviveSize(unsigned n, unsigned limit, RewriteJob& j)
+{
+	unsigned size = 0;
+	j.stack.clear();
+	j.stack.push_back(n);
+	while (!j.stack.empty() && size < limit){
+		unsigned g = j.stack.back();
+		j.stack.pop_back();
+		if (j.ref[g] > 0 || _types[g] != AIG_GATE) continue;
+		bool skip = false;
+		for (unsigned i = 0; i < RWR_VARS && !skip; i++) skip = (j.leaves[i]/2 == g);
+		for (unsigned i = 0; i < j.revived.size() && !skip; i++) skip = (j.revived[i] == g);
+		if (skip) continue;
+		j.revived.push_back(g);
+		size++;
+		j.stack.push_back(resolve(_fanin0[g])/2);
+		j.stack.push_back(resolve(_fanin1[g])/2);
+	}
+	return size;
+}
+
+// Build the library graph of the loaded cut; new gates take the free ids
+// up to M first
+unsigned
+CirMgr::buildRewrite(const CirCut& cut, RewriteJob& j)
+{
+	const RwrGraph& g = rwrLib[npnClass[cut.truth & 0xffff]];
+	for (unsigned k = 0; k < g.nodes; k++){
+		unsigned lit[2];
+		for (unsigned m = 0; m < 2; m++){
+			unsigned l = g.fanin[2*k+m];
+			if (l < 2) lit[m] = l;
+			else if (l < 2+2*RWR_VARS) lit[m] = j.in[(l-2)/2] ^ (l & 1);
+			else lit[m] = j.lit[(l-2)/2-RWR_VARS] ^ (l & 1);
+		}
+		while (j.slot <= M && _gates[j.slot] != NULL) j.slot++;
+		unsigned size = _gates.size(), slot = (j.slot <= M)? j.slot : 0;
+		j.lit[k] = resolve(createAnd(lit[0], lit[1], slot));
+		unsigned n = j.lit[k]/2;
+		if ((slot != 0 && n == slot) || n >= size){
+			if (n >= j.ref.size()) j.ref.resize(n+1, 0);
+			j.dead.push_back(n);
+		}
+	}
+	return outLit(g, j);
+}
+
+unsigned
+CirMgr::outLit(const RwrGraph& g, const RewriteJob& j) const
+{
+	unsigned l = g.out;
+	if (l < 2) return l ^ j.phase;
+	if (l < 2+2*RWR_VARS) return j.in[(l-2)/2] ^ (l & 1) ^ j.phase;
+	unsigned lit = j.lit[(l-2)/2-RWR_VARS];
+	return (lit == ~0u)? lit : lit ^ (l & 1) ^ j.phase;
+}
+
+// The fanouts of "id" move to "lit", whose cone is revived if it was dead,
+// and the cone of "id" loses them. The merge keeps the unique table for
+// the rest of the pass.
+void
+CirMgr::replaceGate(unsigned id, unsigned lit, RewriteJob& j)
+{
+	unsigned n = lit/2;
+	if (j.ref[n] == 0 && _types[n] == AIG_GATE){
+		j.stack.clear();
+		j.stack.push_back(n);
+		while (!j.stack.empty()){
+			unsigned g = j.stack.back();
+			j.stack.pop_back();
+			unsigned in[2] = { resolve(_fanin0[g])/2, resolve(_fanin1[g])/2 };
+			for (unsigned k = 0; k < 2; k++)
+				if (j.ref[in[k]]++ == 0 && _types[in[k]] == AIG_GATE) j.stack.push_back(in[k]);
+		}
+	}
+	j.ref[n] += j.ref[id];
+	j.ref[id] = 0;
+	mergeKeepStrash(id, lit);
+	j.stack.clear();
+	j.stack.push_back(id);
+	while (!j.stack.empty()){
+		unsigned g = j.stack.back();
+		j.stack.pop_back();
+		unsigned in[2] = { resolve(_fanin0[g])/2, resolve(_fanin1[g])/2 };
+		for (unsigned k = 0; k < 2; k++)
+			if (--j.ref[in[k]] == 0 && _types[in[k]] == AIG_GATE){
+				j.stack.push_back(in[k]);
+				j.dead.push_back(in[k]);
+			}
+	}
+}
@@ -16,6 +16,11 @@
 #include "cirGate.h"
 #include "util.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIM_X86
+#include <immintrin.h>
+#endif
+
 using namespace std;
 
 /*******************************/
@@ -25,10 +30,79 @@ using namespace std;
 /**************************************/
 /*   Static varaibles and functions   */
 /**************************************/
+// my_random() only yields 31 random bits per call
+static inline SimWord
+randomWord()
+{
+	return ((SimWord)my_random() << 62) ^ ((SimWord)my_random() << 31) ^ (SimWord)my_random();
+}
+
+// All-one mask for an inverted fanin, so that "w ^ phase(inv)" applies the inversion
+static inline SimWord
+phase(bool inv)
+{
+	return inv ? ~(SimWord)0 : 0;
+}
+
+// AND kernels over one round of SIM_WORDS words: out = (a ^ ma) & (b ^ mb)
+typedef void (*SimAndKernel)(SimWord*, const SimWord*, SimWord, const SimWord*, SimWord);
+
+static void
+simAndScalar(SimWord* out, const SimWord* a, SimWord ma, const SimWord* b, SimWord mb)
+{
+	for (unsigned w = 0; w < SIM_WORDS; w++)
+		out[w] = (a[w] ^ ma) & (b[w] ^ mb);
+}
+
+#ifdef SIM_X86
+#if SIM_WORDS % 8 != 0
+#error "SIM_WORDS must be a multiple of 8 for the vector kernels"
+#endif
+
+__attribute__((target("avx2"))) static void
+simAndAvx2(SimWord* out, const SimWord* a, SimWord ma, const SimWord* b, SimWord mb)
+{
+	__m256i va = _mm256_set1_epi64x((long long)ma);
+	__m256i vb = _mm256_set1_epi64x((long long)mb);
+	for (unsigned w = 0; w < SIM_WORDS; w += 4){
+		__m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a+w)), va);
+		__m256i y = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(b+w)), vb);
+		_mm256_storeu_si256((__m256i*)(out+w), _mm256_and_si256(x, y));
+	}
+}
+
+__attribute__((target("avx512f"))) static void
+simAndAvx512(SimWord* out, const SimWord* a, SimWord ma, const SimWord* b, SimWord mb)
+{
+	__m512i va = _mm512_set1_epi64((long long)ma);
+	__m512i vb = _mm512_set1_epi64((long long)mb);
+	for (unsigned w = 0; w < SIM_WORDS; w += 8){
+		__m512i x = _mm512_xor_si512(_mm512_loadu_si512((const void*)(a+w)), va);
+		__m512i y = _mm512_xor_si512(_mm512_loadu_si512((const void*)(b+w)), vb);
+		_mm512_storeu_si512((void*)(out+w), _mm512_and_si512(x, y));
+	}
+}
+#endif
+
+// Pick the widest kernel the CPU (and OS) supports
+static SimAndKernel
+selectSimKernel()
+{
+#ifdef SIM_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) return simAndAvx512;
+	if (__builtin_cpu_supports("avx2")) return simAndAvx2;
+#endif
+	return simAndScalar;
+}
+
+static SimAndKernel simAnd = selectSimKernel();
 
 /************************************************/
 /*   Public member functions about Simulation   */
 /************************************************/
+// Every round assigns SIM_PATTERNS random patterns to the PIs at once;
+// simulation stops after _simLimit rounds in a row split no FEC class
 void
 CirMgr::randomSim()
 {
@@ -38,33 +112,27 @@ CirMgr::randomSim()
 			return;
 		}
 	}
-	RandomNumGen ranum(3345678);
-	GateList::iterator i;
-	unsigned sim_times = _PIs->size()*2;
+	IdList::iterator i;
+	unsigned num = 0, idle = 0;
 	clock_t c;
 	c = clock();
+	// later calls continue the sequence so that they apply new patterns
+	if (!_fecInit) my_srandom(3345678);
 	initsim();
-	for (unsigned t = 0; t < sim_times; t++){
-		for (i = _PIs->begin(); i != _PIs->end(); i++){
-			bool value = ranum(2);
-			i->second->_value = value;
-			i->second->_value_str += BtoS(value);
-			if (_simLog != NULL) *_simLog << BtoS(value);
-		}
-		resetMark(false);
-		for (i = _POs->begin(); i != _POs->end(); i++)
-			DFSsim(i->second);
-		if (_simLog != NULL){
-			*_simLog << " ";
-			for (i = _POs->begin(); i != _POs->end(); i++)
-				*_simLog << BtoS(i->second->_value);
-			*_simLog << endl;
-		}
+	while (idle < _simLimit){
+		for (i = _piList.begin(); i != _piList.end(); i++)
+			for (unsigned w = 0; w < SIM_WORDS; w++)
+				_simValue[*i*SIM_WORDS+w] = randomWord();
+		simulate(SIM_PATTERNS);
+		num += SIM_PATTERNS;
+		if (refineFEC()) idle = 0;
+		else if (_FECgroups.empty()) break;
+		else idle++;
 	}
-	collectFEC();
-	cout << sim_times << " patterns take " << float(clock()-c)/CLOCKS_PER_SEC << " seconds to simulate." << endl;
+	cout << num << " patterns take " << float(clock()-c)/CLOCKS_PER_SEC << " seconds to simulate." << endl;
 }
 
+// Patterns are packed into the PI words and simulated SIM_PATTERNS at a time
 void
 CirMgr::fileSim(ifstream& patternFile)
 {
@@ -80,15 +148,16 @@ CirMgr::fileSim(ifstream& patternFile)
 	}
 	clock_t c;
 	string line;
-	int sim_times = 0;
+	unsigned n = 0, num = 0;
+	IdList::iterator i;
 	c = clock();
 	initsim();
 	while (!patternFile.eof()){
 		getline(patternFile, line);
 		if (line.size() == 0) continue;
-		else if (line.size() != _PIs->size()){
+		else if (line.size() != _piList.size()){
 			cerr << "[ERROR] Pattern(" << line << ") length(" << line.size() << ") does not match the number of input("
-				  << _PIs->size() << ") in a circuit!!" << endl; continue;
+				  << _piList.size() << ") in a circuit!!" << endl; continue;
 		}
 		size_t pos = line.find_first_not_of("01");
 		if (pos != string::npos){
@@ -98,63 +167,84 @@ CirMgr::fileSim(ifstream& patternFile)
 			}
 			continue;
 		}
-		GateList::iterator i;
+		if (n == 0)
+			for (i = _piList.begin(); i != _piList.end(); i++)
+				for (unsigned w = 0; w < SIM_WORDS; w++)
+					_simValue[*i*SIM_WORDS+w] = 0;
 		int j = 0;
-		for (i = _PIs->begin(); i != _PIs->end(); i++){
-			i->second->_value = StoB(line[j]);
-			i->second->_value_str += line[j];
-			j++;
+		for (i = _piList.begin(); i != _piList.end(); i++, j++)
+			if (line[j] == '1')
+				_simValue[*i*SIM_WORDS+n/SIM_WORD_BITS] |= (SimWord)1 << (n%SIM_WORD_BITS);
+		if (++n == SIM_PATTERNS){
+			simulate(n);
+			refineFEC();
+			num += n;
+			n = 0;
 		}
-		resetMark(false);
-		for (i = _POs->begin(); i != _POs->end(); i++)
-			DFSsim(i->second);
-		if (_simLog != NULL){
-			*_simLog << line << " ";
-			for (i = _POs->begin(); i != _POs->end(); i++)
-				*_simLog << BtoS(i->second->_value);
-			*_simLog << endl;
-		}
-		sim_times++;
 	}
-	collectFEC();
-	cout << sim_times << " patterns take " << float(clock()-c)/CLOCKS_PER_SEC << " seconds to simulate." << endl;
+	if (n != 0){
+		simulate(n);
+		refineFEC();
+		num += n;
+	}
+	cout << num << " patterns take " << float(clock()-c)/CLOCKS_PER_SEC << " seconds to simulate." << endl;
 }
 
 /*************************************************/
 /*   Private member functions about Simulation   */
 /*************************************************/
 
+// The cached topological order is only rebuilt when the netlist changed
+// since the last run, and the FEC classes are kept and refined further
+// unless they have not been set up for this netlist yet
 void
 CirMgr::initsim()
 {
-	GateList::iterator i;
-   for (i = _ANDs->begin(); i != _ANDs->end(); i++)
-   	i->second->_value_str = "";
-   for (i = _POs->begin(); i != _POs->end(); i++)
-   	i->second->_value_str = "";
-   for (i = _PIs->begin(); i != _PIs->end(); i++)
-   	i->second->_value_str = "";
+	if (_simValue.size() != _gates.size()*SIM_WORDS)
+		_simValue.assign(_gates.size()*SIM_WORDS, 0);
+	buildDFS();
+	if (!_fecInit) initFEC();
 }
 
+// Evaluate the first n patterns packed in the PI words over _dfsList
+// and write them to the simulation log
 void
-CirMgr::DFSsim(CirGate* g)
+CirMgr::simulate(unsigned n)
 {
-	g->_mark = true;
-	switch (g->_type){
-		case PO_GATE:
-			if (!(g->input()->_mark)) DFSsim(g->input());
-			g->_value = XOR(g->input()->_value,!g->inverted());
-			g->_value_str += BtoS(g->_value);
-			break;
-		case AIG_GATE:
-			if (!(g->left_input()->_mark)) DFSsim(g->left_input());
-			if (!(g->right_input()->_mark)) DFSsim(g->right_input());
-			g->_value = XOR(g->left_input()->_value,!g->left_inverted()) && XOR(g->right_input()->_value,!g->right_inverted());
-			g->_value_str += BtoS(g->_value);
-			break;
-		case PI_GATE: break;
-		case CONST_GATE: break;
-		case UNDEF_GATE: g->_value = false; g->_value_str += BtoS(g->_value); break;
-		default: break;
+	assert(n > 0 && n <= SIM_PATTERNS);
+	SimWord* val = &_simValue[0];
+	IdList::iterator i;
+	for (i = _dfsList.begin(); i != _dfsList.end(); i++){
+		unsigned id = *i;
+		SimWord* out = val + id*SIM_WORDS;
+		switch (_types[id]){
+			case AIG_GATE:
+				simAnd(out, val + _fanin0[id]/2*SIM_WORDS, phase(_fanin0[id]%2),
+				       val + _fanin1[id]/2*SIM_WORDS, phase(_fanin1[id]%2));
+				break;
+			case PO_GATE:
+				for (unsigned w = 0; w < SIM_WORDS; w++)
+					out[w] = val[_fanin0[id]/2*SIM_WORDS+w] ^ phase(_fanin0[id]%2);
+				break;
+			case PI_GATE: continue;
+			case CONST_GATE:
+			case UNDEF_GATE:
+			default:
+				for (unsigned w = 0; w < SIM_WORDS; w++) out[w] = 0;
+				break;
+		}
+	}
+	if (_simLog != NULL){
+		for (unsigned k = 0; k < n; k++){
+			unsigned w = k/SIM_WORD_BITS, b = k%SIM_WORD_BITS;
+			for (i = _piList.begin(); i != _piList.end(); i++)
+				*_simLog << ((val[*i*SIM_WORDS+w] >> b) & 1);
+			*_simLog << " ";
+			for (i = _poList.begin(); i != _poList.end(); i++)
+				*_simLog << ((val[*i*SIM_WORDS+w] >> b) & 1);
+			*_simLog << endl;
+		}
 	}
+	_simNum += n;
+	_roundNum = n;
 }
@@ -0,0 +1,93 @@
+/****************************************************************************
+  FileName     [ cirStrash.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the structural hash (unique) table of AND gates ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-2013 LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_STRASH_H
+#define CIR_STRASH_H
+
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+//------------------------------------------------------------------------
+//   Define classes
+//------------------------------------------------------------------------
+// Maps the fanin literal pair of an AND gate to its gate id.
+// The pair is normalized (smaller literal first), so (a,b) and (b,a) share
+// one entry. Open addressing with linear probing; the table doubles when
+// it becomes half full. Id 0 is the constant gate, so it marks empty slots.
+class StrashTable
+{
+public:
+   StrashTable(size_t n = 0) : _size(0) { init(n); }
+   ~StrashTable() {}
+
+   // Reserve room for about n entries and drop the current contents
+   void init(size_t n) {
+      size_t cap = 16;
+      while (cap < 2*n) cap <<= 1;
+      _table.assign(cap, Entry());
+      _mask = cap-1;
+      _size = 0;
+   }
+   void clear() { init(0); }
+   size_t size() const { return _size; }
+
+   // Return true and the gate id in "id" if the pair (a,b) is present
+   bool check(unsigned a, unsigned b, unsigned& id) const {
+      if (a > b) { unsigned t = a; a = b; b = t; }
+      for (size_t i = hash(a, b) & _mask; _table[i].id != 0; i = (i+1) & _mask)
+         if (_table[i].lit0 == a && _table[i].lit1 == b) { id = _table[i].id; return true; }
+      return false;
+   }
+   // The pair must not be present yet
+   void insert(unsigned a, unsigned b, unsigned id) {
+      if (2*(_size+1) > _table.size()) rehash();
+      if (a > b) { unsigned t = a; a = b; b = t; }
+      place(a, b, id);
+      _size++;
+   }
+
+private:
+   struct Entry {
+      Entry() : lit0(0), lit1(0), id(0) {}
+      unsigned lit0, lit1, id;
+   };
+
+   vector<Entry>  _table;
+   size_t         _mask;
+   size_t         _size;
+
+   // 64-bit finalizer of MurmurHash3 on the packed pair
+   static size_t hash(unsigned a, unsigned b) {
+      uint64_t k = ((uint64_t)a << 32) | b;
+      k ^= k >> 33;
+      k *= 0xff51afd7ed558ccdULL;
+      k ^= k >> 33;
+      k *= 0xc4ceb9fe1a85ec53ULL;
+      k ^= k >> 33;
+      return (size_t)k;
+   }
+   void place(unsigned a, unsigned b, unsigned id) {
+      size_t i = hash(a, b) & _mask;
+      while (_table[i].id != 0) i = (i+1) & _mask;
+      _table[i].lit0 = a;
+      _table[i].lit1 = b;
+      _table[i].id = id;
+   }
+   void rehash() {
+      vector<Entry> old;
+      old.swap(_table);
+      _table.assign(old.size()*2, Entry());
+      _mask = _table.size()-1;
+      for (size_t i = 0; i < old.size(); i++)
+         if (old[i].id != 0) place(old[i].lit0, old[i].lit1, old[i].id);
+   }
+};
+
+#endif // CIR_STRASH_H
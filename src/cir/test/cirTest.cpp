@@ -0,0 +1,176 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "cirMgr.h"
+
+using namespace std;
+
+extern CirMgr* cirMgr;
+
+//
+// Parallel fraig test: an array multiplier is mitered against its balanced
+// and rewritten copy, and fraig(n) must leave the same AIG as fraig(1),
+// with and without a conflict budget.
+//
+struct Aag
+{
+   Aag() : maxVar(0) {}
+
+   unsigned          maxVar;
+   vector<unsigned>  pis, pos, ands;   // ands: output, fanin0, fanin1
+
+   unsigned newAnd(unsigned a, unsigned b) {
+      if (a == 0 || b == 0) return 0;
+      if (a == 1) return b;
+      if (b == 1) return a;
+      ands.push_back(2*++maxVar); ands.push_back(a); ands.push_back(b);
+      return 2*maxVar;
+   }
+   unsigned newOr(unsigned a, unsigned b) { return newAnd(a^1, b^1)^1; }
+   unsigned newXor(unsigned a, unsigned b) {
+      return newOr(newAnd(a, b^1), newAnd(a^1, b));
+   }
+   void write(ostream& os) const {
+      os << "aag " << maxVar << " " << pis.size() << " 0 " << pos.size() << " "
+         << ands.size()/3 << endl;
+      for (size_t i = 0; i < pis.size(); ++i) os << pis[i] << endl;
+      for (size_t i = 0; i < pos.size(); ++i) os << pos[i] << endl;
+      for (size_t i = 0; i < ands.size(); i += 3)
+         os << ands[i] << " " << ands[i+1] << " " << ands[i+2] << endl;
+   }
+   bool read(istream& is) {
+      string aag;
+      unsigned m, i, l, o, a, x;
+      if (!(is >> aag >> m >> i >> l >> o >> a) || aag != "aag" || l != 0) return false;
+      maxVar = m;
+      pis.clear(); pos.clear(); ands.clear();
+      for (unsigned k = 0; k < i; ++k) { is >> x; pis.push_back(x); }
+      for (unsigned k = 0; k < o; ++k) { is >> x; pos.push_back(x); }
+      for (unsigned k = 0; k < 3*a; ++k) { is >> x; ands.push_back(x); }
+      return !is.fail();
+   }
+};
+
+// n x n array multiplier with ripple-carry rows
+void
+buildMult(Aag& g, unsigned n)
+{
+   for (unsigned i = 0; i < 2*n; ++i) g.pis.push_back(2*++g.maxVar);
+   vector<unsigned> acc(2*n, 0);
+   for (unsigned i = 0; i < n; ++i) {
+      unsigned c = 0;
+      for (unsigned j = 0; j < n; ++j) {
+         unsigned pp = g.newAnd(g.pis[j], g.pis[n+i]);
+         unsigned x = g.newXor(acc[i+j], pp);
+         unsigned s = g.newXor(x, c);
+         c = g.newOr(g.newAnd(acc[i+j], pp), g.newAnd(c, x));
+         acc[i+j] = s;
+      }
+      acc[i+n] = c;
+   }
+   g.pos = acc;
+}
+
+// XOR of the outputs of a and b over shared inputs
+void
+buildMiter(const Aag& a, const Aag& b, Aag& m)
+{
+   m = a;
+   vector<unsigned> lit(2*(b.maxVar+1));
+   lit[0] = 0; lit[1] = 1;
+   for (size_t i = 0; i < b.pis.size(); ++i) {
+      lit[b.pis[i]] = a.pis[i];
+      lit[b.pis[i]^1] = a.pis[i]^1;
+   }
+   for (size_t i = 0; i < b.ands.size(); i += 3) {
+      unsigned o = m.newAnd(lit[b.ands[i+1]], lit[b.ands[i+2]]);
+      lit[b.ands[i]] = o;
+      lit[b.ands[i]^1] = o^1;
+   }
+   for (size_t i = 0; i < a.pos.size(); ++i)
+      m.pos[i] = m.newXor(a.pos[i], lit[b.pos[i]]);
+}
+
+// Run the flow of the fraig command with "threads" workers; the result
+// is the written AIG
+bool
+runFraig(const string& file, unsigned threads, int conf, string& result)
+{
+   CirMgr mgr;
+   cirMgr = &mgr;
+   ostringstream log, out;
+   streambuf* old = cout.rdbuf(log.rdbuf());
+   bool ok = mgr.readCircuit(file);
+   if (ok) {
+      mgr.strash();
+      mgr.randomSim();
+      mgr.setFraigLimit(conf, 0, 0);
+      mgr.fraig(threads);
+      mgr.writeAag(out);
+   }
+   cout.rdbuf(old);
+   cirMgr = 0;
+   result = out.str();
+   return ok;
+}
+
+int main()
+{
+   const string multFile = "mult.aag", optFile = "multOpt.aag", miterFile = "miter.aag";
+   Aag mult, opt, miter;
+   buildMult(mult, 8);
+   {
+      ofstream f(multFile.c_str());
+      mult.write(f);
+   }
+   // The copy is balanced and rewritten by the tool itself
+   {
+      CirMgr mgr;
+      cirMgr = &mgr;
+      ostringstream log;
+      streambuf* old = cout.rdbuf(log.rdbuf());
+      bool ok = mgr.readCircuit(multFile);
+      if (ok) {
+         mgr.strash();
+         mgr.balance();
+         mgr.rewrite();
+         ofstream f(optFile.c_str());
+         mgr.writeAag(f);
+      }
+      cout.rdbuf(old);
+      cirMgr = 0;
+      ifstream f(optFile.c_str());
+      if (!ok || !opt.read(f)) {
+         cout << "Cannot build the optimized multiplier" << endl;
+         return 1;
+      }
+   }
+   buildMiter(mult, opt, miter);
+   {
+      ofstream f(miterFile.c_str());
+      miter.write(f);
+   }
+
+   int fail = 0;
+   const int confs[2] = { 0, 1000 };
+   const unsigned threads[3] = { 1, 2, 4 };
+   for (unsigned c = 0; c < 2; ++c) {
+      string serial;
+      if (!runFraig(miterFile, 1, confs[c], serial)) {
+         cout << "Cannot read " << miterFile << endl;
+         return 1;
+      }
+      for (unsigned t = 1; t < 3; ++t) {
+         string parallel;
+         runFraig(miterFile, threads[t], confs[c], parallel);
+         bool same = (parallel == serial);
+         cout << "fraig(" << threads[t] << ") vs fraig(1), conflict limit "
+              << confs[c] << ": " << (same? "same AIG" : "DIFFERENT AIG") << endl;
+         if (!same) ++fail;
+      }
+   }
+   cout << "Parallel fraig: " << (fail? "FAIL" : "OK") << endl;
+   return fail? 1 : 0;
+}
@@ -22,20 +22,6 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <cmath>
 
 
-//=================================================================================================
-// Helper functions:
-
-
-void removeWatch(vec<Clause*>& ws, Clause* elem)
-{
-    if (ws.size() == 0) return;     // (skip lists that are already cleared)
-    int j = 0;
-    for (; ws[j] != elem  ; j++) assert(j < ws.size());
-    for (; j < ws.size()-1; j++) ws[j] = ws[j+1];
-    ws.pop();
-}
-
-
 //=================================================================================================
 // Operations on clauses:
 
@@ -105,7 +91,8 @@ void Solver::newClause(const vec<Lit>& ps_, bool learnt, ClauseId id , bool A)
 
     }else{
         // Allocate clause:
-        Clause* c   = Clause_new(learnt, ps, id);
+        CRef    cr  = ca.alloc(learnt, ps, id);
+        Clause& c   = ca[cr];
 
         if (learnt){
             // Put the second watch on the literal with highest decision level:
@@ -115,47 +102,49 @@ void Solver::newClause(const vec<Lit>& ps_, bool learnt, ClauseId id , bool A)
                 if (level[var(ps[i])] > max)
                     max   = level[var(ps[i])],
                     max_i = i;
-            (*c)[1]     = ps[max_i];
-            (*c)[max_i] = ps[1];
+            c[1]     = ps[max_i];
+            c[max_i] = ps[1];
 
             // Bumping:
             claBumpActivity(c); // (newly learnt clauses should be considered active)
+            c.lbd() = computeLBD(c);
 
             // Enqueue asserting literal:
-            check(enqueue((*c)[0], c));
+            check(enqueue(c[0], cr));
 
             // Store clause:
-            watches[index(~(*c)[0])].push(c);
-            watches[index(~(*c)[1])].push(c);
-            learnts.push(c);
-            stats.learnts_literals += c->size();
+            vec<vec<Watcher> >& ws = c.size() == 2 ? watches_bin : watches;
+            ws[index(~c[0])].push(Watcher(cr, c[1]));
+            ws[index(~c[1])].push(Watcher(cr, c[0]));
+            learnts.push(cr);
+            stats.learnts_literals += c.size();
 
         }else{
             // Store clause:
-            watches[index(~(*c)[0])].push(c);
-            watches[index(~(*c)[1])].push(c);
-            clauses.push(c);
-            stats.clauses_literals += c->size();
+            vec<vec<Watcher> >& ws = c.size() == 2 ? watches_bin : watches;
+            ws[index(~c[0])].push(Watcher(cr, c[1]));
+            ws[index(~c[1])].push(Watcher(cr, c[0]));
+            clauses.push(cr);
+            stats.clauses_literals += c.size();
         }
     }
 }
 
 
-// Disposes a clauses and removes it from watcher lists. NOTE! Low-level; does NOT change the 'clauses' and 'learnts' vector.
+// Disposes a clause. Its watchers stay until the next 'cleanWatches()' (they are recognized by the
+// mark) and its memory until the next 'garbageCollect()'. NOTE! Low-level; does NOT change the
+// 'clauses' and 'learnts' vector.
 //
-void Solver::remove(Clause* c, bool just_dealloc)
+void Solver::remove(CRef cr)
 {
-    if (!just_dealloc){
-        removeWatch(watches[index(~(*c)[0])], c),
-        removeWatch(watches[index(~(*c)[1])], c);
+    Clause& c = ca[cr];
+    if (c.learnt()) stats.learnts_literals -= c.size();
+    else            stats.clauses_literals -= c.size();
 
-        if (c->learnt()) stats.learnts_literals -= c->size();
-        else             stats.clauses_literals -= c->size();
-
-        if (proof != NULL) proof->deleted(c->id());
-    }
+    if (proof != NULL) proof->deleted(c.id());
 
-    xfree(c);
+    c.setMark();
+    ca.free(cr);
 }
 
 
@@ -163,17 +152,78 @@ void Solver::remove(Clause* c, bool just_dealloc)
 // the clause is binary and satisfied, in which case the first literal is true)
 // Returns True if clause is satisfied (will be removed), False otherwise.
 //
-bool Solver::simplify(Clause* c) const
+bool Solver::simplify(const Clause& c) const
 {
     assert(decisionLevel() == 0);
-    for (int i = 0; i < c->size(); i++){
-        if (value((*c)[i]) == l_True)
+    for (int i = 0; i < c.size(); i++){
+        if (value(c[i]) == l_True)
             return true;
     }
     return false;
 }
 
 
+//=================================================================================================
+// Garbage collection:
+
+
+// Drop the watchers of removed clauses.
+//
+void Solver::cleanWatches()
+{
+    for (int type = 0; type < 2; type++){
+        vec<vec<Watcher> >& wss = type ? watches_bin : watches;
+        for (int i = 0; i < wss.size(); i++){
+            vec<Watcher>& ws = wss[i];
+            int           j  = 0;
+            for (int k = 0; k < ws.size(); k++)
+                if (!ca[ws[k].cref].mark())
+                    ws[j++] = ws[k];
+            ws.shrink(ws.size() - j);
+        }
+    }
+}
+
+
+// Copy every clause still referred to into 'to'. Watchers of removed clauses must be cleaned first.
+//
+void Solver::relocAll(ClauseAllocator& to)
+{
+    // All watchers:
+    for (int type = 0; type < 2; type++){
+        vec<vec<Watcher> >& wss = type ? watches_bin : watches;
+        for (int i = 0; i < wss.size(); i++){
+            vec<Watcher>& ws = wss[i];
+            for (int j = 0; j < ws.size(); j++)
+                ca.reloc(ws[j].cref, to);
+        }
+    }
+
+    // All reasons:
+    for (int i = 0; i < trail.size(); i++){
+        Var v = var(trail[i]);
+        if (reason[v] != CRef_Undef){
+            assert(!ca[reason[v]].mark());
+            ca.reloc(reason[v], to);
+        }
+    }
+
+    // All clauses:
+    for (int i = 0; i < learnts.size(); i++) ca.reloc(learnts[i], to);
+    for (int i = 0; i < clauses.size(); i++) ca.reloc(clauses[i], to);
+}
+
+
+// Compact the clause memory by copying the live clauses to a new allocator.
+//
+void Solver::garbageCollect()
+{
+    ClauseAllocator to(ca.size() - ca.wasted());
+    relocAll(to);
+    to.moveTo(ca);
+}
+
+
 //=================================================================================================
 // Minor methods:
 
@@ -186,13 +236,17 @@ Var Solver::newVar() {
     index = nVars();
     watches     .push();          // (list for positive literal)
     watches     .push();          // (list for negative literal)
-    reason      .push(NULL);
+    watches_bin .push();
+    watches_bin .push();
+    reason      .push(CRef_Undef);
     assigns     .push(toInt(l_Undef));
     level       .push(-1);
     trail_pos   .push(-1);
     activity    .push(0);
+    polarity    .push(1);
     order       .newVar();
     analyze_seen.push(0);
+    lbd_seen    .push(0);
     if (proof != NULL) unit_id.push(ClauseId_NULL);
     return index; }
 
@@ -209,7 +263,8 @@ void Solver::cancelUntil(int level) {
         for (int c = trail.size()-1; c >= trail_lim[level]; c--){
             Var     x  = var(trail[c]);
             assigns[x] = toInt(l_Undef);
-            reason [x] = NULL;
+            reason [x] = CRef_Undef;
+            if (phase_saving) polarity[x] = (char)sign(trail[c]);
             order.undo(x); }
         trail.shrink(trail.size() - trail_lim[level]);
         trail_lim.shrink(trail_lim.size() - level);
@@ -222,7 +277,7 @@ void Solver::cancelUntil(int level) {
 
 /*_________________________________________________________________________________________________
 |
-|  analyze : (confl : Clause*) (out_learnt : vec<Lit>&) (out_btlevel : int&)  ->  [void]
+|  analyze : (confl : CRef) (out_learnt : vec<Lit>&) (out_btlevel : int&)  ->  [void]
 |  
 |  Description:
 |    Analyze conflict and produce a reason clause ('out_learnt') and a backtracking level
@@ -243,7 +298,7 @@ public:
     lastToFirst_lt(const vec<int>& t) : trail_pos(t) {}
     bool operator () (Lit p, Lit q) { return trail_pos[var(p)] > trail_pos[var(q)]; }
 };
-void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
+void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
 {
     vec<char>&     seen  = analyze_seen;
     int            pathC = 0;
@@ -251,16 +306,21 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
 
     // Generate conflict clause:
     //
-    if (proof != NULL) proof->beginChain(confl->id());
+    if (proof != NULL) proof->beginChain(ca[confl].id());
     out_learnt.push();          // (leave room for the asserting literal)
     out_btlevel = 0;
     int index = trail.size()-1;
     for(;;){
-        assert(confl != NULL);  // (otherwise should be UIP)
-
-        Clause& c = *confl;
-        if (c.learnt())
-            claBumpActivity(&c);
+        assert(confl != CRef_Undef);    // (otherwise should be UIP)
+
+        Clause& c = (p == lit_Undef) ? ca[confl] : reasonClause(var(p));
+        if (c.learnt()){
+            claBumpActivity(c);
+            // Clauses that keep taking part in conflicts get the LBD of the current assignment, if lower:
+            if (c.lbd() > 2){
+                uint lbd = computeLBD(c);
+                if (lbd + 1 < c.lbd()) c.lbd() = lbd; }
+        }
 
         for (int j = (p == lit_Undef) ? 0 : 1; j < c.size(); j++){
             Lit q = c[j];
@@ -287,7 +347,7 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
         pathC--;
         if (pathC == 0) break;
 
-        if (proof != NULL) proof->resolve(confl->id(), ~p);
+        if (proof != NULL) proof->resolve(ca[confl].id(), ~p);
     }
     out_learnt[0] = ~p;
 
@@ -303,18 +363,18 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
 
         analyze_toclear.clear();
         for (i = j = 1; i < out_learnt.size(); i++)
-            if (reason[var(out_learnt[i])] == NULL || !analyze_removable(out_learnt[i], min_level))
+            if (reason[var(out_learnt[i])] == CRef_Undef || !analyze_removable(out_learnt[i], min_level))
                 out_learnt[j++] = out_learnt[i];
     }else if(expensive_ccmin == 1){
         // Simplify conflict clause (a little):
         //
         analyze_toclear.clear();
         for (i = j = 1; i < out_learnt.size(); i++){
-            Clause* r = reason[var(out_learnt[i])];
-            if (r == NULL)
+            CRef r = reason[var(out_learnt[i])];
+            if (r == CRef_Undef)
                 out_learnt[j++] = out_learnt[i];
             else{
-                Clause& c = *r;
+                Clause& c = reasonClause(var(out_learnt[i]));
                 for (int k = 1; k < c.size(); k++)
                     if (!seen[var(c[k])] && level[var(c[k])] != 0){
                         out_learnt[j++] = out_learnt[i];
@@ -333,7 +393,7 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
         for (int k = 0; k < analyze_toclear.size(); k++){
             Var     v = var(analyze_toclear[k]); assert(level[v] > 0);
 				Lit     l = analyze_toclear[k];
-            Clause& c = *reason[v];
+            Clause& c = reasonClause(v);
             proof->resolve(c.id(), l);
             for (int k = 1; k < c.size(); k++)
                 if (level[var(c[k])] == 0)
@@ -356,17 +416,17 @@ void Solver::analyze(Clause* confl, vec<Lit>& out_learnt, int& out_btlevel)
 //
 bool Solver::analyze_removable(Lit p, uint min_level)
 {
-    assert(reason[var(p)] != NULL);
+    assert(reason[var(p)] != CRef_Undef);
     analyze_stack.clear(); analyze_stack.push(p);
     int top = analyze_toclear.size();
     while (analyze_stack.size() > 0){
-        assert(reason[var(analyze_stack.last())] != NULL);
-        Clause& c = *reason[var(analyze_stack.last())];
+        assert(reason[var(analyze_stack.last())] != CRef_Undef);
+        Clause& c = reasonClause(var(analyze_stack.last()));
         analyze_stack.pop();
         for (int i = 1; i < c.size(); i++){
             Lit p = c[i];
             if (!analyze_seen[var(p)] && level[var(p)] != 0){
-                if (reason[var(p)] != NULL && ((1 << (level[var(p)] & 31)) & min_level) != 0){
+                if (reason[var(p)] != CRef_Undef && ((1 << (level[var(p)] & 31)) & min_level) != 0){
                     analyze_seen[var(p)] = 1;
                     analyze_stack.push(p);
                     analyze_toclear.push(p);
@@ -387,15 +447,15 @@ bool Solver::analyze_removable(Lit p, uint min_level)
 
 /*_________________________________________________________________________________________________
 |
-|  analyzeFinal : (confl : Clause*) (skip_first : bool)  ->  [void]
+|  analyzeFinal : (cr : CRef) (skip_first : bool)  ->  [void]
 |  
 |  Description:
 |    Specialized analysis procedure to express the final conflict in terms of assumptions.
 |    'root_level' is allowed to point beyond end of trace (useful if called after conflict while
-|    making assumptions). If 'skip_first' is TRUE, the first literal of 'confl' is  ignored (needed
+|    making assumptions). If 'skip_first' is TRUE, the first literal of 'cr' is  ignored (needed
 |    if conflict arose before search even started).
 |________________________________________________________________________________________________@*/
-void Solver::analyzeFinal(Clause* confl, bool skip_first)
+void Solver::analyzeFinal(CRef cr, bool skip_first)
 {
     // -- NOTE! This code is relatively untested. Please report bugs!
     conflict.clear();
@@ -404,10 +464,13 @@ void Solver::analyzeFinal(Clause* confl, bool skip_first)
         return; }
    //assert(false);
     vec<char>&     seen  = analyze_seen;
-    if (proof != NULL) proof->beginChain(confl->id());
-    for (int i = skip_first ? 1 : 0; i < confl->size(); i++){
-        Var     x = var((*confl)[i]);
-		  Lit		 l = (*confl)[i];
+    Clause&        confl = ca[cr];
+    if (skip_first && value(confl[0]) != l_True){   // (a binary reason may have its implied literal second)
+        Lit t = confl[0]; confl[0] = confl[1], confl[1] = t; }
+    if (proof != NULL) proof->beginChain(confl.id());
+    for (int i = skip_first ? 1 : 0; i < confl.size(); i++){
+        Var     x = var(confl[i]);
+		  Lit		 l = confl[i];
         if (level[x] > 0)
             seen[x] = 1;
         else
@@ -419,12 +482,12 @@ void Solver::analyzeFinal(Clause* confl, bool skip_first)
         Var     x = var(trail[i]);
 		  Lit     l = trail[i];
         if (seen[x]){
-            Clause* r = reason[x];
-            if (r == NULL){
+            CRef r = reason[x];
+            if (r == CRef_Undef){
                 assert(level[x] > 0);
                 conflict.push(~trail[i]);
             }else{
-                Clause& c = *r;
+                Clause& c = reasonClause(x);
                 if (proof != NULL) proof->resolve(c.id(), l);
                 for (int j = 1; j < c.size(); j++)
                     if (level[var(c[j])] > 0)
@@ -441,7 +504,7 @@ void Solver::analyzeFinal(Clause* confl, bool skip_first)
 
 /*_________________________________________________________________________________________________
 |
-|  enqueue : (p : Lit) (from : Clause*)  ->  [bool]
+|  enqueue : (p : Lit) (from : CRef)  ->  [bool]
 |  
 |  Description:
 |    Puts a new fact on the propagation queue as well as immediately updating the variable's value.
@@ -450,12 +513,12 @@ void Solver::analyzeFinal(Clause* confl, bool skip_first)
 |  Input:
 |    p    - The fact to enqueue
 |    from - [Optional] Fact propagated from this (currently) unit clause. Stored in 'reason[]'.
-|           Default value is NULL (no reason).
+|           Default value is CRef_Undef (no reason).
 |  
 |  Output:
 |    TRUE if fact was enqueued without conflict, FALSE otherwise.
 |________________________________________________________________________________________________@*/
-bool Solver::enqueue(Lit p, Clause* from)
+bool Solver::enqueue(Lit p, CRef from)
 {
     if (value(p) != l_Undef)
         return value(p) != l_False;
@@ -474,28 +537,52 @@ bool Solver::enqueue(Lit p, Clause* from)
 
 /*_________________________________________________________________________________________________
 |
-|  propagate : [void]  ->  [Clause*]
+|  propagate : [void]  ->  [CRef]
 |  
 |  Description:
 |    Propagates all enqueued facts. If a conflict arises, the conflicting clause is returned,
-|    otherwise NULL. NOTE! This method has been optimized for speed rather than readability.
+|    otherwise CRef_Undef. Binary clauses are propagated first, from their implication lists and
+|    without reading the clause memory. NOTE! This method has been optimized for speed rather
+|    than readability.
 |  
 |    Post-conditions:
 |      * The propagation queue is empty, even if there was a conflict.
 |________________________________________________________________________________________________@*/
-Clause* Solver::propagate()
+CRef Solver::propagate()
 {
-    Clause* confl = NULL;
+    CRef    confl = CRef_Undef;
     while (qhead < trail.size()){
         stats.propagations++;
         simpDB_props--;
 
         Lit            p  = trail[qhead++];     // 'p' is enqueued fact to propagate.
-        vec<Clause*>&  ws = watches[index(p)];
-        Clause**       i,** j,** end;
 
-        for (i = j = (Clause**)ws, end = i + ws.size();  i != end;){
-            Clause& c = **i; i++;
+        // Binary clauses imply their other literal directly:
+        vec<Watcher>&  wbin = watches_bin[index(p)];
+        for (int k = 0; k < wbin.size(); k++){
+            Lit imp = wbin[k].blocker;
+            if (value(imp) == l_True) continue;
+            if (decisionLevel() == 0 && proof != NULL)
+                logUnit(ca[wbin[k].cref], imp);
+            if (!enqueue(imp, wbin[k].cref)){
+                if (decisionLevel() == 0)
+                    ok = false;
+                confl = wbin[k].cref;
+                qhead = trail.size();
+                break; }
+        }
+        if (confl != CRef_Undef) break;
+
+        vec<Watcher>&  ws = watches[index(p)];
+        Watcher        *i, *j, *end;
+
+        for (i = j = (Watcher*)ws, end = i + ws.size();  i != end;){
+            // Satisfied by the blocker, no need to look at the clause:
+            if (value(i->blocker) == l_True){
+                *j++ = *i++; continue; }
+
+            CRef    cr = i->cref;
+            Clause& c  = ca[cr]; i++;
             // Make sure the false literal is data[1]:
             Lit false_lit = ~p;
             if (c[0] == false_lit)
@@ -504,41 +591,28 @@ Clause* Solver::propagate()
             assert(c[1] == false_lit);
 
             // If 0th watch is true, then clause is already satisfied.
-            Lit   first = c[0];
-            lbool val   = value(first);
+            Lit     first = c[0];
+            Watcher w(cr, first);
+            lbool   val   = value(first);
             if (val == l_True){
-                *j++ = &c;
+                *j++ = w;
             }else{
                 // Look for new watch:
                 for (int k = 2; k < c.size(); k++)
                     if (value(c[k]) != l_False){
                         c[1] = c[k]; c[k] = false_lit;
-                        watches[index(~c[1])].push(&c);
+                        watches[index(~c[1])].push(w);
                         goto FoundWatch; }
 
                 // Did not find watch -- clause is unit under assignment:
-                if (decisionLevel() == 0 && proof != NULL){
-                    // Log the production of this unit clause:
-                    proof->beginChain(c.id());
-                    for (int k = 1; k < c.size(); k++)
-                        proof->resolve(unit_id[var(c[k])], c[k]);
-                    ClauseId id = proof->endChain();
-                    assert(unit_id[var(first)] == ClauseId_NULL || value(first) == l_False);    // (if variable already has 'id', it must be with the other polarity and we should have derived the empty clause here)
-                    if (value(first) != l_False)
-                        unit_id[var(first)] = id;
-                    else{
-                        // Empty clause derived:
-                        proof->beginChain(unit_id[var(first)]);
-                        proof->resolve(id, ~first);
-                        proof->endChain();
-                    }
-                }
+                if (decisionLevel() == 0 && proof != NULL)
+                    logUnit(c, first);
 					 
-                *j++ = &c;
-                if (!enqueue(first, &c)){
+                *j++ = w;
+                if (!enqueue(first, cr)){
                     if (decisionLevel() == 0)
                         ok = false;
-                    confl = &c;
+                    confl = cr;
                     qhead = trail.size();
                     // Copy the remaining watches:
                     while (i < end)
@@ -554,34 +628,62 @@ Clause* Solver::propagate()
 }
 
 
+// Log the production of the unit clause 'first' from 'c', whose other literals are false at the
+// root level.
+//
+void Solver::logUnit(const Clause& c, Lit first)
+{
+    proof->beginChain(c.id());
+    for (int k = 0; k < c.size(); k++)
+        if (c[k] != first)
+            proof->resolve(unit_id[var(c[k])], c[k]);
+    ClauseId id = proof->endChain();
+    assert(unit_id[var(first)] == ClauseId_NULL || value(first) == l_False);    // (if variable already has 'id', it must be with the other polarity and we should have derived the empty clause here)
+    if (value(first) != l_False)
+        unit_id[var(first)] = id;
+    else{
+        // Empty clause derived:
+        proof->beginChain(unit_id[var(first)]);
+        proof->resolve(id, ~first);
+        proof->endChain();
+    }
+}
+
+
 /*_________________________________________________________________________________________________
 |
 |  reduceDB : ()  ->  [void]
 |  
 |  Description:
-|    Remove half of the learnt clauses, minus the clauses locked by the current assignment. Locked
-|    clauses are clauses that are reason to some assignment. Binary clauses are never removed.
+|    Remove the worse half of the learnt clauses, minus the clauses locked by the current assignment.
+|    Locked clauses are clauses that are reason to some assignment. Clauses are ranked by LBD, then
+|    by activity. Binary clauses and glue clauses (LBD 2) are never removed.
 |________________________________________________________________________________________________@*/
-struct reduceDB_lt { bool operator () (Clause* x, Clause* y) { return x->size() > 2 && (y->size() == 2 || x->activity() < y->activity()); } };
+struct reduceDB_lt {
+    const ClauseAllocator& ca;
+    reduceDB_lt(const ClauseAllocator& ca_) : ca(ca_) {}
+    bool operator () (CRef x, CRef y) {
+        const Clause& a = ca[x];
+        const Clause& b = ca[y];
+        if (a.size() == 2 || b.size() == 2) return a.size() > 2 && b.size() == 2;
+        if (a.lbd() != b.lbd()) return a.lbd() > b.lbd();
+        return a.activity() < b.activity(); } };
 void Solver::reduceDB()
 {
     int     i, j;
-    double  extra_lim = cla_inc / learnts.size();    // Remove any clause below this activity
 
-    sort(learnts, reduceDB_lt());
+    sort(learnts, reduceDB_lt(ca));
     for (i = j = 0; i < learnts.size() / 2; i++){
-        if (learnts[i]->size() > 2 && !locked(learnts[i]))
-            remove(learnts[i]);
-        else
-            learnts[j++] = learnts[i];
-    }
-    for (; i < learnts.size(); i++){
-        if (learnts[i]->size() > 2 && !locked(learnts[i]) && learnts[i]->activity() < extra_lim)
+        if (ca[learnts[i]].size() > 2 && ca[learnts[i]].lbd() > 2 && !locked(learnts[i]))
             remove(learnts[i]);
         else
             learnts[j++] = learnts[i];
     }
+    for (; i < learnts.size(); i++)
+        learnts[j++] = learnts[i];
     learnts.shrink(i - j);
+    cleanWatches();
+    checkGarbage();
 }
 
 
@@ -598,7 +700,7 @@ void Solver::simplifyDB()
     if (!ok) return;    // GUARD (public method)
     assert(decisionLevel() == 0);
 
-    if (propagate() != NULL){
+    if (propagate() != CRef_Undef){
         ok = false;
         return; }
 
@@ -608,43 +710,64 @@ void Solver::simplifyDB()
     // Clear watcher lists:
     for (int i = simpDB_assigns; i < nAssigns(); i++){
         Lit p = trail[i];
-        watches[index( p)].clear(true);
-        watches[index(~p)].clear(true);
+        watches    [index( p)].clear(true);
+        watches    [index(~p)].clear(true);
+        watches_bin[index( p)].clear(true);
+        watches_bin[index(~p)].clear(true);
     }
 
     // Remove satisfied clauses:
     for (int type = 0; type < 2; type++){
-        vec<Clause*>& cs = type ? learnts : clauses;
+        vec<CRef>&    cs = type ? learnts : clauses;
         int           j  = 0;
         for (int i = 0; i < cs.size(); i++){
-            if (!locked(cs[i]) && simplify(cs[i]))
+            if (!locked(cs[i]) && simplify(ca[cs[i]]))
                 remove(cs[i]);
             else
                 cs[j++] = cs[i];
         }
         cs.shrink(cs.size()-j);
     }
+    cleanWatches();
+    checkGarbage();
 
     simpDB_assigns = nAssigns();
     simpDB_props   = stats.clauses_literals + stats.learnts_literals;   // (shouldn't depend on 'stats' really, but it will do for now)
 }
 
 
+// Next decision: the variable from the activity order, signed by its preferred polarity.
+// Returns 'lit_Undef' if all variables are assigned.
+//
+Lit Solver::pickBranchLit(const SearchParams& params)
+{
+    Var next = order.select(params.random_var_freq);
+    return next == var_Undef ? lit_Undef : Lit(next, polarity[next]);
+}
+
+
 /*_________________________________________________________________________________________________
 |
-|  search : (nof_conflicts : int) (nof_learnts : int) (params : const SearchParams&)  ->  [lbool]
+|  search : (nof_conflicts : int) (params : const SearchParams&)  ->  [lbool]
 |  
 |  Description:
-|    Search for a model the specified number of conflicts, keeping the number of learnt clauses
-|    below the provided limit. NOTE! Use negative value for 'nof_conflicts' or 'nof_learnts' to
-|    indicate infinity.
+|    Search for a model the specified number of conflicts, reducing the learnt clauses every
+|    'reduce_first + k*reduce_inc' conflicts. NOTE! Use negative value for 'nof_conflicts' to
+|    indicate infinity; with 'restart_glucose' the search restarts on its own (see below).
 |  
 |  Output:
 |    'l_True' if a partial assigment that is consistent with respect to the clauseset is found. If
 |    all variables are decision variables, this means that the clause set is satisfiable. 'l_False'
 |    if the clause set is unsatisfiable. 'l_Undef' if the bound on number of conflicts is reached.
 |________________________________________________________________________________________________@*/
-lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& params)
+// Glucose restarts: restart when the average LBD of the last 'lbd_queue' learnt clauses times
+// 'restart_K' exceeds the average of all; after 'block_after' conflicts, a conflict with a trail
+// 'block_R' times longer than the recent average postpones the next restart.
+static const double restart_K   = 0.8;
+static const double block_R     = 1.4;
+static const int64  block_after = 10000;
+
+lbool Solver::search(int nof_conflicts, const SearchParams& params)
 {
     if (!ok) return l_False;    // GUARD (public method)
     assert(root_level == decisionLevel());
@@ -656,30 +779,42 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
     model.clear();
 
     for (;;){
-        Clause* confl = propagate();
-        if (confl != NULL){
+        CRef confl = propagate();
+        if (confl != CRef_Undef){
             // CONFLICT
 
             stats.conflicts++; conflictC++;
+            if (time_budget >= 0 && realTime() >= time_budget) timed_out = true;
             vec<Lit>    learnt_clause;
             int         backtrack_level;
             if (decisionLevel() == root_level){
                 // Contradiction found:
                 analyzeFinal(confl);
                 return l_False; }
+            if (restart_mode == restart_glucose){
+                trail_queue.push(trail.size());
+                if (stats.conflicts > block_after && lbd_queue.isvalid() && trail.size() > block_R * trail_queue.avg())
+                    lbd_queue.clear(); }
             analyze(confl, learnt_clause, backtrack_level);
             cancelUntil(max(backtrack_level, root_level));
             newClause(learnt_clause, true, (proof != NULL) ? proof->last() : ClauseId_NULL);
             if (learnt_clause.size() == 1) level[var(learnt_clause[0])] = 0;    // (this is ugly (but needed for 'analyzeFinal()') -- in future versions, we will backtrack past the 'root_level' and redo the assumptions)
+            uint lbd = (learnt_clause.size() == 1) ? 1 : ca[learnts.last()].lbd();
+            lbd_queue.push(lbd);
+            sum_lbd += lbd;
             varDecayActivity();
             claDecayActivity();
 
         }else{
             // NO CONFLICT
 
-            if (nof_conflicts >= 0 && conflictC >= nof_conflicts){
-                // Reached bound on number of conflicts:
+            bool restart = (nof_conflicts >= 0 && conflictC >= nof_conflicts)
+                        || (restart_mode == restart_glucose && lbd_queue.isvalid()
+                            && lbd_queue.avg() * restart_K > (double)sum_lbd / stats.conflicts);
+            if (restart || !withinBudget()){
+                // Reached bound on number of conflicts (of this restart or of the whole call):
                 progress_estimate = progressEstimate();
+                lbd_queue.clear();
                 cancelUntil(root_level);
                 return l_Undef; }
 
@@ -687,15 +822,17 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
                 // Simplify the set of problem clauses:
                 simplifyDB(), assert(ok);
 
-            if (nof_learnts >= 0 && learnts.size()-nAssigns() >= nof_learnts)
+            if (stats.conflicts >= next_reduce){
                 // Reduce the set of learnt clauses:
-                reduceDB();
+                nof_reduces++;
+                next_reduce = stats.conflicts + reduce_first + (int64)reduce_inc * nof_reduces;
+                reduceDB(); }
 
             // New variable decision:
             stats.decisions++;
-            Var next = order.select(params.random_var_freq);
+            Lit next = pickBranchLit(params);
 
-            if (next == var_Undef){
+            if (next == lit_Undef){
                 // Model found:
                 model.growTo(nVars());
                 for (int i = 0; i < nVars(); i++) model[i] = value(i);
@@ -703,7 +840,7 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
                 return l_True;
             }
 
-            check(assume(~Lit(next)));
+            check(assume(next));
         }
     }
 }
@@ -737,32 +874,56 @@ void Solver::varRescaleActivity()
 void Solver::claRescaleActivity()
 {
     for (int i = 0; i < learnts.size(); i++)
-        learnts[i]->activity() *= 1e-20;
+        ca[learnts[i]].activity() *= 1e-20;
     cla_inc *= 1e-20;
 }
 
 
 /*_________________________________________________________________________________________________
 |
-|  solve : (assumps : const vec<Lit>&)  ->  [bool]
+|  solveLimited : (assumps : const vec<Lit>&)  ->  [lbool]
 |  
 |  Description:
 |    Top-level solve. If using assumptions (non-empty 'assumps' vector), you must call
 |    'simplifyDB()' first to see that no top-level conflict is present (which would put the solver
-|    in an undefined state).
+|    in an undefined state). Returns 'l_Undef' if the conflict or propagation budget ran out
+|    before the problem was decided.
 |  
 |  Input:
 |    A list of assumptions (unit clauses coded as literals). Pre-condition: The assumptions must
 |    not contain both 'x' and '~x' for any variable 'x'.
 |________________________________________________________________________________________________@*/
-bool Solver::solve(const vec<Lit>& assumps)
+// Finite subsequences of the Luby-sequence:
+//
+//   0: 1
+//   1: 1 1 2
+//   2: 1 1 2 1 1 2 4
+//   3: 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8
+//   ...
+//
+// Returns y^k where k is the x-th element of the sequence (counted from 0).
+static double luby(double y, int x)
+{
+    // Find the finite subsequence that contains index 'x', and the size of that subsequence:
+    int size, seq;
+    for (size = 1, seq = 0; size < x+1; seq++, size = 2*size+1);
+
+    while (size-1 != x){
+        size = (size-1)>>1;
+        seq--;
+        x = x % size;
+    }
+    return pow(y, seq);
+}
+
+lbool Solver::solveLimited(const vec<Lit>& assumps)
 {
     simplifyDB();
-    if (!ok) return false;
+    if (!ok) return l_False;
 
     SearchParams    params(default_params);
     double  nof_conflicts = 100;
-    double  nof_learnts   = nClauses() / 3;
+    int     nof_restarts  = 0;
     lbool   status        = l_Undef;
 
     // Perform assumptions:
@@ -771,7 +932,7 @@ bool Solver::solve(const vec<Lit>& assumps)
         Lit p = assumps[i];
         assert(var(p) < nVars());
         if (!assume(p)){
-            if (reason[var(p)] != NULL){
+            if (reason[var(p)] != CRef_Undef){
                 analyzeFinal(reason[var(p)], true);
                 conflict.push(~p);
             }else{
@@ -781,12 +942,12 @@ bool Solver::solve(const vec<Lit>& assumps)
                 if (proof != NULL) conflict_id = unit_id[var(p)];
             }
             cancelUntil(0);
-            return false; }
-        Clause* confl = propagate();
-        if (confl != NULL){
+            return l_False; }
+        CRef confl = propagate();
+        if (confl != CRef_Undef){
             analyzeFinal(confl), assert(conflict.size() > 0);
             cancelUntil(0);
-            return false; }
+            return l_False; }
     }
     assert(root_level == decisionLevel());
 
@@ -802,21 +963,25 @@ bool Solver::solve(const vec<Lit>& assumps)
         reportf("===================================\n");
     }
 
-    while (status == l_Undef){
+    while (status == l_Undef && withinBudget()){
         if (verbosity >= 1){
             printStats();
             reportf("| %9d | %7d %8d | %7d %7d %8d %7.1f | %6.3f %% |\n",
                    (int)stats.conflicts, nClauses(),
                    (int)stats.clauses_literals,
-                   (int)nof_learnts, nLearnts(),
+                   (int)(next_reduce - stats.conflicts), nLearnts(),
                    (int)stats.learnts_literals,
                    (double)stats.learnts_literals/nLearnts(),
                    progress_estimate*100);
             fflush(stdout);
         }
-        status = search((int)nof_conflicts, (int)nof_learnts, params);
-        nof_conflicts *= 1.5;
-        nof_learnts   *= 1.1;
+        switch (restart_mode){
+            case restart_luby:    nof_conflicts = 100 * luby(2, nof_restarts); break;
+            case restart_glucose: nof_conflicts = -1; break;
+            default: break; }
+        status = search((int)nof_conflicts, params);
+        if (restart_mode == restart_geometric) nof_conflicts *= 1.5;
+        nof_restarts++;
     }
     if (verbosity >= 1) {
         reportf("===========================================");
@@ -824,7 +989,7 @@ bool Solver::solve(const vec<Lit>& assumps)
     }
 
     cancelUntil(0);
-    return status == l_True;
+    return status;
 }
 
 void Solver::printStats()
@@ -46,41 +46,86 @@ struct SearchParams {
 };
 
 
+// Restart policies of 'solveLimited()':
+enum { restart_geometric = 0,   // 100 conflicts, growing by 1.5 (MiniSat 1.14)
+       restart_luby      = 1,   // 100 conflicts times the Luby sequence
+       restart_glucose   = 2 }; // when recent learnt clauses have a high LBD compared to all
+
+// 'reduceDB()' runs after 'reduce_first' conflicts, then each time after 'reduce_inc' more than the last time:
+enum { reduce_first = 2000, reduce_inc = 300 };
+
+
+// Keeps the sum of the last 'maxsize' values pushed (for glucose restarts).
+class BoundedQueue {
+    vec<uint>   elems;
+    int         first, last, maxsize, queuesize;
+    uint64      sumofqueue;
+public:
+    BoundedQueue(int size) : first(0), last(0), maxsize(size), queuesize(0), sumofqueue(0) { elems.growTo(size); }
+
+    void    push(uint x) {
+        if (queuesize == maxsize){
+            sumofqueue -= elems[last];
+            if (++last == maxsize) last = 0;
+        }else
+            queuesize++;
+        sumofqueue += x;
+        elems[first] = x;
+        if (++first == maxsize) first = 0; }
+    bool    isvalid() const { return queuesize == maxsize; }
+    double  avg    () const { return (double)sumofqueue / queuesize; }
+    void    clear  ()       { first = last = queuesize = 0; sumofqueue = 0; }
+};
+
+
 class Solver {
 protected:
     // Solver state:
     //
     bool                ok;               // If FALSE, the constraints are already unsatisfiable. No part of the solver state may be used!
-    vec<Clause*>        clauses;          // List of problem clauses.
-    vec<Clause*>        learnts;          // List of learnt clauses.
+    ClauseAllocator     ca;               // Memory of all clauses.
+    vec<CRef>           clauses;          // List of problem clauses.
+    vec<CRef>           learnts;          // List of learnt clauses.
     vec<ClauseId>       unit_id;          // 'unit_id[var]' is the clause ID for the unit literal 'var' or '~var' (if set at toplevel).
     double              cla_inc;          // Amount to bump next clause with.
     double              cla_decay;        // INVERSE decay factor for clause activity: stores 1/decay.
 
     vec<double>         activity;         // A heuristic measurement of the activity of a variable.
+    vec<char>           polarity;         // 'polarity[var]' is the preferred sign to branch on (1 = negative). Saved on backtrack if 'phase_saving'.
     double              var_inc;          // Amount to bump next variable with.
     double              var_decay;        // INVERSE decay factor for variable activity: stores 1/decay. Use negative value for static variable order.
     VarOrder            order;            // Keeps track of the decision variable order.
 
-    vec<vec<Clause*> >  watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    vec<vec<Watcher> >  watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    vec<vec<Watcher> >  watches_bin;      // 'watches_bin[lit]' lists the binary clauses with '~lit'; the blocker is the literal implied when 'lit' becomes true.
     vec<char>           assigns;          // The current assignments (lbool:s stored as char:s).
     vec<Lit>            trail;            // Assignment stack; stores all assigments made in the order they were made.
     vec<int>            trail_lim;        // Separator indices for different decision levels in 'trail[]'.
-    vec<Clause*>        reason;           // 'reason[var]' is the clause that implied the variables current value, or 'NULL' if none.
+    vec<CRef>           reason;           // 'reason[var]' is the clause that implied the variables current value, or 'CRef_Undef' if none.
     vec<int>            level;            // 'level[var]' is the decision level at which assignment was made.
     vec<int>            trail_pos;        // 'trail_pos[var]' is the variable's position in 'trail[]'. This supersedes 'level[]' in some sense, and 'level[]' will probably be removed in future releases.
     int                 root_level;       // Level of first proper decision.
     int                 qhead;            // Head of queue (as index into the trail -- no more explicit propagation queue in MiniSat).
     int                 simpDB_assigns;   // Number of top-level assignments since last execution of 'simplifyDB()'.
     int64               simpDB_props;     // Remaining number of propagations that must be made before next execution of 'simplifyDB()'.
+    int64               conflict_budget;  // 'stats.conflicts' at which 'solveLimited()' gives up, or -1 for no limit.
+    int64               propagation_budget; // 'stats.propagations' at which 'solveLimited()' gives up, or -1 for no limit.
+    double              time_budget;      // 'realTime()' at which 'solveLimited()' gives up, or -1 for no limit.
+    bool                timed_out;        // Set by 'search()' when a conflict happens after 'time_budget'.
+    double              garbage_frac;     // Collect garbage when this fraction of the clause memory is wasted.
+    vec<uint>           lbd_seen;         // 'lbd_seen[level]' is the stamp of the last LBD computation that met 'level'.
+    uint                lbd_stamp;
+    int64               next_reduce;      // 'stats.conflicts' at which 'reduceDB()' runs next.
+    int                 nof_reduces;
+    BoundedQueue        lbd_queue;        // LBDs of the recent learnt clauses (glucose restarts).
+    BoundedQueue        trail_queue;      // Trail sizes at the recent conflicts (glucose restart blocking).
+    uint64              sum_lbd;          // Sum of the LBDs of all learnt clauses.
 
     // Temporaries (to reduce allocation overhead). Each variable is prefixed by the method in which is used:
     //
     vec<char>           analyze_seen;
     vec<Lit>            analyze_stack;
     vec<Lit>            analyze_toclear;
-    Clause*             propagate_tmpbin;
-    Clause*             analyze_tmpbin;
     vec<Lit>            addUnit_tmp;
     vec<Lit>            addBinary_tmp;
     vec<Lit>            addTernary_tmp;
@@ -91,14 +136,15 @@ protected:
     void        cancelUntil      (int level);
     void        record           (const vec<Lit>& clause);
 
-    void        analyze          (Clause* confl, vec<Lit>& out_learnt, int& out_btlevel); // (bt = backtrack)
+    void        analyze          (CRef confl, vec<Lit>& out_learnt, int& out_btlevel);    // (bt = backtrack)
     bool        analyze_removable(Lit p, uint min_level);                                 // (helper method for 'analyze()')
-    void        analyzeFinal     (Clause* confl, bool skip_first = false);
-    bool        enqueue          (Lit fact, Clause* from = NULL);
-    Clause*     propagate        ();
+    void        analyzeFinal     (CRef confl, bool skip_first = false);
+    bool        enqueue          (Lit fact, CRef from = CRef_Undef);
+    CRef        propagate        ();
+    void        logUnit          (const Clause& c, Lit first);
     void        reduceDB         ();
     Lit         pickBranchLit    (const SearchParams& params);
-    lbool       search           (int nof_conflicts, int nof_learnts, const SearchParams& params);
+    lbool       search           (int nof_conflicts, const SearchParams& params);
     double      progressEstimate ();
 
     // Activity:
@@ -115,10 +161,35 @@ protected:
     // Operations on clauses:
     //
     void     newClause(const vec<Lit>& ps, bool learnt = false, ClauseId id = ClauseId_NULL, bool A = true);
-    void     claBumpActivity (Clause* c) { if ( (c->activity() += cla_inc) > 1e20 ) claRescaleActivity(); }
-    void     remove          (Clause* c, bool just_dealloc = false);
-    bool     locked          (const Clause* c) const { return reason[var((*c)[0])] == c; }
-    bool     simplify        (Clause* c) const;
+    void     claBumpActivity (Clause& c) { if ( (c.activity() += cla_inc) > 1e20 ) claRescaleActivity(); }
+    void     remove          (CRef cr);
+    bool     locked          (CRef cr) const {
+        const Clause& c = ca[cr];
+        return reason[var(c[0])] == cr || (c.size() == 2 && reason[var(c[1])] == cr); }
+    // The reason of 'x' with the implied literal first. Binary reasons are set without looking at
+    // the clause, so their literals may still be in the other order:
+    Clause&  reasonClause    (Var x) {
+        Clause& c = ca[reason[x]];
+        if (var(c[0]) != x){ assert(c.size() == 2); Lit t = c[0]; c[0] = c[1], c[1] = t; }
+        return c; }
+    bool     simplify        (const Clause& c) const;
+
+    // Number of distinct decision levels among the literals (works for 'vec<Lit>' and 'Clause'):
+    template<class Lits>
+    uint     computeLBD      (const Lits& ps) {
+        if (++lbd_stamp == 0){ for (int i = 0; i < lbd_seen.size(); i++) lbd_seen[i] = 0; lbd_stamp = 1; }
+        uint n = 0;
+        for (int i = 0; i < ps.size(); i++){
+            int l = level[var(ps[i])];
+            if (lbd_seen[l] != lbd_stamp) lbd_seen[l] = lbd_stamp, n++; }
+        return n; }
+
+    // Garbage collection of the clause memory:
+    //
+    void     cleanWatches    ();
+    void     relocAll        (ClauseAllocator& to);
+    void     checkGarbage    () { if (ca.wasted() > ca.size() * garbage_frac) garbageCollect(); }
+    void     garbageCollect  ();
 
     int      decisionLevel() const { return trail_lim.size(); }
 
@@ -132,27 +203,33 @@ public:
              , qhead            (0)
              , simpDB_assigns   (0)
              , simpDB_props     (0)
+             , conflict_budget  (-1)
+             , propagation_budget(-1)
+             , time_budget      (-1)
+             , timed_out        (false)
+             , garbage_frac     (0.20)
+             , lbd_stamp        (0)
+             , next_reduce      (reduce_first)
+             , nof_reduces      (0)
+             , lbd_queue        (50)
+             , trail_queue      (5000)
+             , sum_lbd          (0)
              , default_params   (SearchParams(0.95, 0.999, 0.02))
+             , restart_mode     (restart_geometric)
+             , phase_saving     (true)
              , expensive_ccmin  (2)
              , proof            (NULL)
              , verbosity        (0)
              , progress_estimate(0)
              , conflict_id      (ClauseId_NULL)
              {
-                vec<Lit> dummy(2,lit_Undef);
-                propagate_tmpbin = Clause_new(false, dummy);
-                analyze_tmpbin   = Clause_new(false, dummy);
+                lbd_seen      .push(0);         // (levels go from 0 to 'nVars()')
                 addUnit_tmp   .growTo(1);
                 addBinary_tmp .growTo(2);
                 addTernary_tmp.growTo(3);
              }
 
-   ~Solver() {
-       for (int i = 0; i < learnts.size(); i++) remove(learnts[i], true);
-       for (int i = 0; i < clauses.size(); i++) if (clauses[i] != NULL) remove(clauses[i], true);
-       remove(propagate_tmpbin, true);
-       remove(analyze_tmpbin, true);
-    }
+   ~Solver() {}     // (the clauses go with 'ca')
 
     // Helpers: (semi-internal)
     //
@@ -172,6 +249,8 @@ public:
     // Mode of operation:
     //
     SearchParams    default_params;     // Restart frequency etc.
+    int             restart_mode;       // 'restart_geometric' (the default), 'restart_luby' or 'restart_glucose'.
+    bool            phase_saving;       // Branch on the last value a variable had before backtracking. TRUE by default.
     int             expensive_ccmin;    // Controls conflict clause minimization. TRUE by default.
     Proof*          proof;              // Set this directly after constructing 'Solver' to enable proof logging. Initialized to NULL.
     int             verbosity;          // Verbosity level. 0=silent, 1=some progress report, 2=everything
@@ -184,14 +263,28 @@ public:
     void    addBinary (Lit p, Lit q)        { addBinary_tmp [0] = p; addBinary_tmp [1] = q; addClause(addBinary_tmp); }
     void    addTernary(Lit p, Lit q, Lit r) { addTernary_tmp[0] = p; addTernary_tmp[1] = q; addTernary_tmp[2] = r; addClause(addTernary_tmp); }
     void    addClause (const vec<Lit>& ps , bool A = true)  { newClause(ps , false , ClauseId_NULL , A); }  
+    void    setPolarity(Var x, bool neg)    { polarity[x] = (char)neg; }    // Preferred first value of 'x' (FALSE if 'neg'; the default).
 	 // (used to be a difference between internal and external method...)
 
     // Solving:
     //
     bool    okay() { return ok; }       // FALSE means solver is in an conflicting state (must never be used again!)
     void    simplifyDB();
-    bool    solve(const vec<Lit>& assumps);
+    bool    solve(const vec<Lit>& assumps) { budgetOff(); return solveLimited(assumps) == l_True; }
     bool    solve() { vec<Lit> tmp; return solve(tmp); }
+    lbool   solveLimited(const vec<Lit>& assumps);  // 'l_Undef' if the budget ran out.
+
+    // Resource limits: (counted from the time of the call; only 'solveLimited()' stops when one runs out,
+    // 'solve()' turns them off first and always gives an answer)
+    //
+    void    setConfBudget(int64 x) { conflict_budget    = stats.conflicts    + x; }
+    void    setPropBudget(int64 x) { propagation_budget = stats.propagations + x; }
+    void    setTimeBudget(double t){ time_budget = t; timed_out = false; }  // (absolute 'realTime()', checked at each conflict)
+    void    budgetOff()            { conflict_budget = propagation_budget = -1; time_budget = -1; timed_out = false; }
+    bool    withinBudget() const   {
+        return (conflict_budget    < 0 || stats.conflicts    < conflict_budget)
+            && (propagation_budget < 0 || stats.propagations < propagation_budget)
+            && (time_budget        < 0 || !timed_out); }
 
     double      progress_estimate;  // Set by 'search()'.
     vec<lbool>  model;              // If problem is satisfiable, this vector contains the model (if any).
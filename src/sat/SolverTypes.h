@@ -81,60 +81,123 @@ const   int ClauseId_NULL = INT_MIN;
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+// Clauses live in a 'ClauseAllocator' and are referred to by their 32-bit offset ('CRef') in it.
+typedef uint CRef;
+const   CRef CRef_Undef = UINT_MAX;
+
 class Clause {
-    uint    size_learnt;
-    Lit     data[1];
-public:
+    uint    header;     // size << 4 | reloced << 3 | has_id << 2 | mark << 1 | learnt
+    Lit     data[1];    // The literals, then the activity and LBD (if learnt), then the ID (if logging proof).
+
+    friend class ClauseAllocator;
     // NOTE: This constructor cannot be used directly (doesn't allocate enough memory).
-    Clause(bool learnt, const vec<Lit>& ps, ClauseId id_ = ClauseId_NULL) {
-        size_learnt = (ps.size() << 1) | (int)learnt;
+    Clause(bool learnt, const vec<Lit>& ps, ClauseId id_) {
+        header = (ps.size() << 4) | ((int)(id_ != ClauseId_NULL) << 2) | (int)learnt;
         for (int i = 0; i < ps.size(); i++) data[i] = ps[i];
-        if (learnt) activity() = 0;
+        if (learnt) activity() = 0, lbd() = 0;
         if (id_ != ClauseId_NULL) id() = id_; }
 
-    // -- use this function instead:
-    friend Clause* Clause_new(bool, const vec<Lit>&, ClauseId);
-
-    int       size        ()      const { return size_learnt >> 1; }
-    bool      learnt      ()      const { return size_learnt & 1; }
+public:
+    int       size        ()      const { return header >> 4; }
+    bool      learnt      ()      const { return header & 1; }
+    bool      mark        ()      const { return header & 2; }     // (set when the clause is removed)
+    void      setMark     ()            { header |= 2; }
+    bool      hasId       ()      const { return header & 4; }
+    bool      reloced     ()      const { return header & 8; }
+    CRef      relocation  ()      const { return (CRef)index(data[0]); }
+    void      relocate    (CRef c)      { header |= 8; data[0] = toLit((int)c); }
+    uint      words       ()      const { return 1 + size() + 2*(int)learnt() + (int)hasId(); }
     Lit       operator [] (int i) const { return data[i]; }
     Lit&      operator [] (int i)       { return data[i]; }
     float&    activity    ()      const {
         void *p = const_cast<Lit*>(&data[size()]); return *((float *)p);
     } //              return *((float*)&data[size()]); }
-    ClauseId& id          ()      const { return *((ClauseId*)&data[size() + (int)learnt()]); }
+    uint&     lbd         ()      const { return *((uint*)&data[size() + 1]); }  // (literal block distance, learnt only)
+    ClauseId& id          ()      const { return *((ClauseId*)&data[size() + 2*(int)learnt()]); }
 };
 
-inline Clause* Clause_new(bool learnt, const vec<Lit>& ps, ClauseId id = ClauseId_NULL) {
-    assert(sizeof(Lit)      == sizeof(uint));
-    assert(sizeof(float)    == sizeof(uint));
-    assert(sizeof(ClauseId) == sizeof(uint));
-    void*   mem = xmalloc<char>(sizeof(Clause) + sizeof(uint)*(ps.size() + (int)learnt + (int)(id != ClauseId_NULL)));
-    return new (mem) Clause(learnt, ps, id); }
-
 
 //=================================================================================================
-// GClause -- Generalize clause:
+// ClauseAllocator -- contiguous clause memory:
+
+
+// Clauses are allocated one after another in a single array of 32-bit words. Freed clauses only
+// count as wasted space until 'Solver::garbageCollect()' copies the live ones to a new allocator.
+class ClauseAllocator {
+    uint*   memory;
+    uint    sz;
+    uint    cap;
+    uint    wasted_;
+
+    void    capacity(uint min_cap) {
+        if (min_cap <= cap) return;
+        uint prev = cap;
+        if (cap == 0) cap = 1024;
+        while (cap < min_cap){
+            uint delta = ((cap >> 1) + (cap >> 3) + 2) & ~1u;   // (grow by about 1.6)
+            cap += delta;
+            if (cap <= prev) { cap = UINT_MAX; break; } }       // (wrapped around)
+        assert(min_cap <= cap);
+        memory = xrealloc(memory, cap); }
+
+    // Disallow copying (not implemented):
+    ClauseAllocator& operator = (const ClauseAllocator& other);
+                     ClauseAllocator(const ClauseAllocator& other);
 
-
-// Either a pointer to a clause or a literal.
-class GClause {
-    void*   data;
-    GClause(void* d) : data(d) {}
 public:
-    friend GClause GClause_new(Lit p);
-    friend GClause GClause_new(Clause* c);
-
-    bool        isLit    () const { return ((uintp)data & 1) == 1; }
-    Lit         lit      () const { return toLit(((intp)data) >> 1); }
-    Clause*     clause   () const { return (Clause*)data; }
-    bool        operator == (GClause c) const { return data == c.data; }
-    bool        operator != (GClause c) const { return data != c.data; }
+    ClauseAllocator(uint start_cap = 0) : memory(NULL), sz(0), cap(0), wasted_(0) { capacity(start_cap); }
+   ~ClauseAllocator() { if (memory != NULL) xfree(memory); }
+
+    CRef alloc(bool learnt, const vec<Lit>& ps, ClauseId id = ClauseId_NULL) {
+        assert(sizeof(Lit)      == sizeof(uint));
+        assert(sizeof(float)    == sizeof(uint));
+        assert(sizeof(ClauseId) == sizeof(uint));
+        uint n = 1 + ps.size() + 2*(int)learnt + (int)(id != ClauseId_NULL);
+        assert(sz < CRef_Undef - n);
+        capacity(sz + n);
+        CRef cr = sz;
+        sz += n;
+        new (memory + cr) Clause(learnt, ps, id);
+        return cr; }
+    void free(CRef cr) { wasted_ += (*this)[cr].words(); }
+
+    Clause&       operator [] (CRef cr)       { return *(Clause*)(memory + cr); }
+    const Clause& operator [] (CRef cr) const { return *(const Clause*)(memory + cr); }
+
+    uint size  () const { return sz; }
+    uint wasted() const { return wasted_; }
+
+    // Copy the clause 'cr' to 'to' (once) and update 'cr' to its new offset:
+    void reloc(CRef& cr, ClauseAllocator& to) {
+        Clause& c = (*this)[cr];
+        if (c.reloced()) { cr = c.relocation(); return; }
+        uint n = c.words();
+        to.capacity(to.sz + n);
+        CRef nc = to.sz;
+        to.sz += n;
+        memcpy(to.memory + nc, memory + cr, n * sizeof(uint));
+        c.relocate(nc);
+        cr = nc; }
+
+    void moveTo(ClauseAllocator& to) {
+        if (to.memory != NULL) xfree(to.memory);
+        to.memory = memory; to.sz = sz; to.cap = cap; to.wasted_ = wasted_;
+        memory = NULL; sz = cap = wasted_ = 0; }
 };
-inline GClause GClause_new(Lit p)     { return GClause((void*)(((intp)index(p) << 1) + 1)); }
-inline GClause GClause_new(Clause* c) { assert(((uintp)c & 1) == 0); return GClause((void*)c); }
 
-#define GClause_NULL GClause_new((Clause*)NULL)
+
+//=================================================================================================
+// Watcher -- an entry of a watcher list:
+
+
+// 'blocker' is some literal of the clause other than the watched one. If it is true, the clause is
+// satisfied and 'propagate()' skips it without touching the clause memory.
+struct Watcher {
+    CRef    cref;
+    Lit     blocker;
+    Watcher() : cref(CRef_Undef) {}
+    Watcher(CRef c, Lit p) : cref(c), blocker(p) {}
+};
 
 
 //=================================================================================================
@@ -20,7 +20,7 @@ class SatSolver
 {
    public : 
       SatSolver():_solver(0) { }
-      ~SatSolver() { }
+      ~SatSolver() { if (_solver) delete _solver; }
 
       // Solver initialization and reset
       void initialize() {
@@ -65,12 +65,45 @@ class SatSolver
          _solver->addClause(lits); lits.clear();
       }
 
+      // Miter "va != vb" (vb inverted if fb) that only holds while "act" is
+      // assumed true; assertProperty(act, false) retires its clauses
+      void addMiterCNF(Var act, Var va, Var vb, bool fb) {
+         vec<Lit> lits;
+         Lit lact = Lit(act);
+         Lit la = Lit(va);
+         Lit lb = fb? ~Lit(vb): Lit(vb);
+         lits.push(~lact); lits.push( la); lits.push( lb);
+         _solver->addClause(lits); lits.clear();
+         lits.push(~lact); lits.push(~la); lits.push(~lb);
+         _solver->addClause(lits); lits.clear();
+      }
+
+      // Restart policy: restart_geometric (the default), restart_luby or
+      // restart_glucose; reset() goes back to the default
+      void setRestart(int mode) { _solver->restart_mode = mode; }
+
+      // Value the solver tries first when it branches on v; phase saving
+      // replaces it once v has been assigned and backtracked
+      void setPolarity(Var v, bool val) { _solver->setPolarity(v, !val); }
+
       // For incremental proof, use "assumeSolve()"
       void assumeRelease() { _assump.clear(); }
       void assumeProperty(Var prop, bool val) {
          _assump.push(val? Lit(prop): ~Lit(prop));
       }
       bool assumpSolve() { return _solver->solve(_assump); }
+      // Return 1/0/-1; -1 means the budget ran out before a result
+      int assumpSolveLimited() {
+         lbool r = _solver->solveLimited(_assump);
+         return (r==l_True?1:(r==l_False?0:-1)); }
+      // Budgets counted from now; 0 leaves that resource unlimited.
+      // "deadline" is an absolute realTime(), 0 for none.
+      void setBudget(int conflicts, int propagations, double deadline = 0) {
+         _solver->budgetOff();
+         if (conflicts > 0) _solver->setConfBudget(conflicts);
+         if (propagations > 0) _solver->setPropBudget(propagations);
+         if (deadline > 0) _solver->setTimeBudget(deadline);
+      }
 
       // For one time proof, use "solve"
       void assertProperty(Var prop, bool val) {
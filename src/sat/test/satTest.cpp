@@ -73,6 +73,158 @@ void reportResult(const SatSolver& solver, bool result)
    }
 }
 
+//
+// Clause store test: random 3-SAT with selector-guarded clause groups,
+// solved incrementally under assumptions and again with small conflict
+// budgets. It runs long enough for reduceDB() to drop learnt clauses and
+// for the clause arena to be garbage collected.
+//
+// Solver with its clause store exposed to the checks
+class ProbeSolver : public Solver
+{
+public:
+   int reduces() const { return nof_reduces; }
+   unsigned arenaSize() const { return ca.size(); }
+};
+
+typedef vector<vector<Lit> > ClauseList;
+
+const int nVar = 150, nGroup = 8, nQuery = 24;
+
+unsigned randSeed = 1;
+unsigned
+randNum(unsigned n)
+{
+   randSeed = randSeed * 1103515245u + 12345u;
+   return (randSeed >> 8) % n;
+}
+
+void
+randClauses(ClauseList& cls, int n)
+{
+   for (int i = 0; i < n; ++i) {
+      vector<Lit> c;
+      while (c.size() < 3) {
+         Var v = randNum(nVar);
+         bool dup = false;
+         for (size_t j = 0; j < c.size(); ++j) dup |= (var(c[j]) == v);
+         if (!dup) c.push_back(Lit(v, randNum(2)));
+      }
+      cls.push_back(c);
+   }
+}
+
+void
+addClauses(Solver& s, const ClauseList& cls, Var sel = var_Undef)
+{
+   vec<Lit> lits;
+   for (size_t i = 0; i < cls.size(); ++i) {
+      lits.clear();
+      for (size_t j = 0; j < cls[i].size(); ++j) lits.push(cls[i][j]);
+      if (sel != var_Undef) lits.push(~Lit(sel));
+      s.addClause(lits);
+   }
+}
+
+bool
+modelSatisfies(const Solver& s, const ClauseList& cls)
+{
+   for (size_t i = 0; i < cls.size(); ++i) {
+      bool sat = false;
+      for (size_t j = 0; j < cls[i].size() && !sat; ++j)
+         sat = (s.modelValue(var(cls[i][j])) == (sign(cls[i][j])? l_False: l_True));
+      if (!sat) return false;
+   }
+   return true;
+}
+
+// Groups enabled by query q
+unsigned
+queryMask(int q)
+{
+   return (q * 0x9du + 0x35u) & ((1u << nGroup) - 1);
+}
+
+int
+testClauseStore()
+{
+   ClauseList base, groups[nGroup];
+   randClauses(base, nVar * 38 / 10);
+   for (int g = 0; g < nGroup; ++g) randClauses(groups[g], nVar / 10);
+
+   ProbeSolver inc, lim;
+   for (int v = 0; v < nVar + nGroup; ++v) { inc.newVar(); lim.newVar(); }
+   addClauses(inc, base);
+   addClauses(lim, base);
+   for (int g = 0; g < nGroup; ++g) {
+      addClauses(inc, groups[g], nVar + g);
+      addClauses(lim, groups[g], nVar + g);
+   }
+
+   int fail = 0, satNum = 0, budgetRuns = 0;
+   bool collected = false;
+   unsigned lastSize = 0;
+   for (int q = 0; q < nQuery; ++q) {
+      unsigned mask = queryMask(q);
+      vec<Lit> assump;
+      ClauseList active(base);
+      for (int g = 0; g < nGroup; ++g) {
+         bool on = (mask >> g) & 1;
+         assump.push(Lit(nVar + g, !on));
+         if (on) active.insert(active.end(), groups[g].begin(), groups[g].end());
+      }
+      // Incremental, unlimited
+      bool r1 = inc.solve(assump);
+      if (inc.arenaSize() < lastSize) collected = true;
+      lastSize = inc.arenaSize();
+      if (r1 && !modelSatisfies(inc, active)) {
+         cout << "query " << q << ": incremental model violates a clause" << endl;
+         ++fail;
+      }
+      // Incremental, in slices of 200 conflicts
+      lbool r2 = l_Undef;
+      while (r2 == l_Undef) {
+         unsigned before = lim.arenaSize();
+         lim.setConfBudget(200);
+         r2 = lim.solveLimited(assump);
+         if (lim.arenaSize() < before) collected = true;
+         ++budgetRuns;
+      }
+      lim.budgetOff();
+      if ((r2 == l_True) != r1) {
+         cout << "query " << q << ": budgeted answer differs" << endl;
+         ++fail;
+      }
+      if (r2 == l_True && !modelSatisfies(lim, active)) {
+         cout << "query " << q << ": budgeted model violates a clause" << endl;
+         ++fail;
+      }
+      // UNSAT answers are confirmed by a fresh solver without selectors
+      if (!r1) {
+         Solver fresh;
+         for (int v = 0; v < nVar; ++v) fresh.newVar();
+         addClauses(fresh, active);
+         if (fresh.solve()) {
+            cout << "query " << q << ": UNSAT answer is wrong" << endl;
+            ++fail;
+         }
+      }
+      else ++satNum;
+   }
+   if (inc.reduces() == 0 || lim.reduces() == 0) {
+      cout << "reduceDB() never ran" << endl;
+      ++fail;
+   }
+   if (!collected) {
+      cout << "the clause arena was never collected" << endl;
+      ++fail;
+   }
+   cout << "Clause store: " << nQuery << " queries (" << satNum << " SAT), "
+        << budgetRuns << " budgeted calls, " << inc.reduces() << "/" << lim.reduces()
+        << " reductions: " << (fail? "FAIL" : "OK") << endl;
+   return fail;
+}
+
 int main()
 {
    initCircuit();
@@ -103,4 +255,6 @@ int main()
    solver.assumeProperty(gates[4]->getVar(), true);  // Gate(3) = 1
    result = solver.assumpSolve();
    reportResult(solver, result);
+
+   return testClauseStore()? 1 : 0;
 }